@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <board.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <evaluation.hpp>
+#include <fen.hpp>
+#include <filesystem>
+#include <fstream>
+#include <move_gen.hpp>
+#include <move_list.hpp>
+#include <packed.hpp>
+#include <search.hpp>
+#include <string>
+#include <thread>
+#include <tt.hpp>
+#include <vector>
+
+// Measures the throughput of parts of the engine, which the unit tests only check for correctness
+// Usage: bench
+namespace {
+using Clock = std::chrono::steady_clock;
+
+size_t Micros(Clock::time_point from, Clock::time_point to) {
+    return std::max<size_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(to - from).count(), 1
+    );
+}
+
+// Collects every position reachable within the depth
+void Collect(Board &board, int depth, std::vector<Board> &boards) {
+    boards.push_back(board);
+    if (depth == 0) return;
+    for (const auto &move : GenerateMovesAll(board, board.Turn())) {
+        board.ApplyMove(move);
+        if (board.IsKingSafe(~board.Turn())) Collect(board, depth - 1, boards);
+        board.UndoMove(move);
+    }
+}
+
+std::vector<Board> Collect(const std::vector<std::string> &fens, int depth) {
+    std::vector<Board> boards;
+    for (const std::string &fen : fens) {
+        Board board = Board(fen);
+        Collect(board, depth, boards);
+    }
+    return boards;
+}
+
+// The set-wise pawn structure evaluation against the pawn by pawn one it replaced
+void BenchPawns() {
+    const std::vector<Board> boards = Collect(
+        {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "4k3/pp1p1pp1/1P1P2P1/P1p1P3/2P2p1p/1p3P1P/1P1p1P2/4K3 w - - 0 1",
+            "4k3/p1p1p1p1/p1p1p1p1/8/8/P1P1P1P1/P1P1P1P1/4K3 w - - 0 1",
+        },
+        3
+    );
+    // The scores are summed, such that no evaluation is left out as unused
+    const auto time = [&boards](auto eval, int &checksum) {
+        const auto t1 = Clock::now();
+        for (int i = 0; i < 20; i++)
+            for (const Board &board : boards) {
+                const Score score = eval(board);
+                checksum += score.MG() + score.EG();
+            }
+        return Micros(t1, Clock::now());
+    };
+    int checksum      = 0;
+    const size_t loop = time(Evaluation::Internal::EvalPawnsLoop, checksum);
+    const size_t set  = time(Evaluation::Internal::EvalPawns, checksum);
+    printf("pawn structure positions %zu ", boards.size());
+    printf("set-wise %zu us loop %zu us checksum %d\n", set, loop, checksum);
+}
+
+// Evaluations of a batch of positions, against those one by one
+void BenchBatch() {
+    const std::vector<Board> boards = Collect(
+        {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "4k3/pp1p1pp1/1P1P2P1/P1p1P3/2P2p1p/1p3P1P/1P1p1P2/7K b - - 0 1",
+        },
+        3
+    );
+    std::vector<Position> positions;
+    for (const Board &board : boards)
+        positions.push_back(board.GetPosition());
+
+    // Each is run several times, as batches are evaluated repeatedly, such as when tuning
+    constexpr size_t RUNS = 10;
+    std::vector<int> evals(positions.size());
+    const auto pps = [&positions](size_t us) { return RUNS * positions.size() * 1000000 / us; };
+    const auto t1  = Clock::now();
+    for (size_t run = 0; run < RUNS; run++)
+        for (size_t i = 0; i < boards.size(); i++)
+            evals[i] = Evaluation::Eval(boards[i]);
+    const auto t2 = Clock::now();
+    for (size_t run = 0; run < RUNS; run++)
+        Evaluation::EvalBatch(positions, evals, 1);
+    const auto t3 = Clock::now();
+    for (size_t run = 0; run < RUNS; run++)
+        Evaluation::EvalBatch(positions, evals);
+    const auto t4 = Clock::now();
+    printf("batch positions %zu single pps %zu ", positions.size(), pps(Micros(t1, t2)));
+    printf("batch pps %zu threaded pps %zu\n", pps(Micros(t2, t3)), pps(Micros(t3, t4)));
+}
+
+// Loading positions from a text file, on one thread and on all
+void BenchLoad() {
+    const std::string path   = std::filesystem::temp_directory_path() / "sunbird_bench.epd";
+    const std::string fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "rnbqkbnr/ppp1pppp/8/8/3pP3/5NP1/PPPP1P1P/RNBQKB1R b KQkq e3 0 3",
+        "r1bq1rk1/pp2bppp/2n2n2/3p4/3P4/2NB1N2/PP3PPP/R1BQ1RK1 b - - 12 10",
+    };
+    constexpr size_t COUNT = 1000000;
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (size_t i = 0; i < COUNT; i++)
+            file << fens[i % std::size(fens)] << '\n';
+    }
+    const auto t1             = Clock::now();
+    const FEN::Batch single   = FEN::Load(path, 1);
+    const auto t2             = Clock::now();
+    const FEN::Batch threaded = FEN::Load(path);
+    const auto t3             = Clock::now();
+    std::filesystem::remove(path);
+    const auto pps = [](size_t count, size_t us) { return count * 1000000 / us; };
+    printf("load positions %zu ", single.positions.size());
+    printf("single pps %zu ", pps(single.positions.size(), Micros(t1, t2)));
+    printf("threaded pps %zu\n", pps(threaded.positions.size(), Micros(t2, t3)));
+}
+
+// Reading positions packed into records, mapped and streamed, against parsing them as text
+void BenchPacked() {
+    const std::string path   = std::filesystem::temp_directory_path() / "sunbird_bench.pack";
+    const std::string text   = std::filesystem::temp_directory_path() / "sunbird_bench.epd";
+    const std::string fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r1bq1rk1/pp2bppp/2n2n2/3p4/3P4/2NB1N2/PP3PPP/R1BQ1RK1 b - - 12 10",
+    };
+    constexpr size_t COUNT = 1000000;
+    {
+        Packed::Writer writer(path);
+        std::ofstream file(text, std::ios::binary);
+        const Packed::Record records[] = {
+            Packed::Pack(Board(fens[0])),
+            Packed::Pack(Board(fens[1])),
+            Packed::Pack(Board(fens[2])),
+            Packed::Pack(Board(fens[3])),
+        };
+        for (size_t i = 0; i < COUNT; i++) {
+            writer.Write(records[i % std::size(records)]);
+            file << fens[i % std::size(fens)] << '\n';
+        }
+    }
+    const size_t packedSize = std::filesystem::file_size(path);
+    const size_t textSize   = std::filesystem::file_size(text);
+
+    // The hashes of the unpacked boards are summed, such that none is left out as unused
+    uint64_t checksum = 0;
+    const auto t1     = Clock::now();
+    Packed::Mapping mapping(path);
+    for (const Packed::Record &record : mapping.Records())
+        checksum += Packed::Unpack(record).GetHash();
+    const auto t2 = Clock::now();
+    Packed::Reader reader(path);
+    for (Packed::Record record; reader.Next(record);)
+        checksum += Packed::Unpack(record).GetHash();
+    const auto t3 = Clock::now();
+    for (const Position &position : FEN::Load(text, 1).positions)
+        checksum += position.hash;
+    const auto t4 = Clock::now();
+    std::filesystem::remove(path);
+    std::filesystem::remove(text);
+    printf("packed positions %zu bytes %zu fen bytes %zu ", COUNT, packedSize, textSize);
+    printf("mapped %zu us streamed %zu us ", Micros(t1, t2), Micros(t2, t3));
+    printf("fen %zu us checksum %zu\n", Micros(t3, t4), static_cast<size_t>(checksum));
+}
+
+// Time from a stop of a search until it returns, over several searches of the same position
+void BenchStop() {
+    const std::string fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    constexpr size_t RUNS = 10;
+    size_t total          = 0;
+    size_t worst          = 0;
+    TT::Init();
+    for (size_t run = 0; run < RUNS; run++) {
+        Board board = Board(fen);
+        Search::Limits limits;
+        limits.infinite = true;
+        Search::SearchLimit limit;
+        size_t latency = 0;
+        std::thread search([&] {
+            Search::GetBestRootMove(board, limits, limit);
+            latency = limit.StopLatency().count();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50 + 10 * run));
+        limit.Stop();
+        search.join();
+        total += latency;
+        worst  = std::max(worst, latency);
+    }
+    TT::Clean();
+    printf("stop latency mean %zu us worst %zu us\n", total / RUNS, worst);
+}
+} // namespace
+
+int main() {
+    BenchPawns();
+    BenchBatch();
+    BenchLoad();
+    BenchPacked();
+    BenchStop();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+#include <algorithm>
+#include <cstdlib>
+#include <datagen.hpp>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Generates training data by self-play, appending the positions to the file as packed records
+// Each move is searched for the nodes and to the depth, either of which is left out as zero
+// Usage: datagen <file> [games] [threads] [nodes] [depth]
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <file> [games] [threads] [nodes] [depth]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string path = argv[1];
+    Datagen::Options options;
+    if (argc > 2) options.games = std::stoul(argv[2]);
+    if (argc > 3) options.threads = std::stoul(argv[3]);
+    if (argc > 4) options.nodes = std::stoul(argv[4]);
+    if (argc > 5) options.depth = std::stoul(argv[5]);
+    if (options.nodes == 0 && options.depth == 0) {
+        std::cerr << "either nodes or depth must be given" << std::endl;
+        return EXIT_FAILURE;
+    }
+    options.seed = std::random_device()();
+
+    const Datagen::Stats stats = Datagen::Generate(path, options, [](const Datagen::Stats &stats) {
+        if (stats.games % 100 == 0)
+            std::cout << "games " << stats.games << " positions " << stats.positions << " time "
+                      << stats.time << " ms" << std::endl;
+    });
+    if (stats.games == 0) {
+        std::cerr << "failed to write " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const size_t pps = stats.positions * 1000 / std::max<size_t>(stats.time, 1);
+    std::cout << "games " << stats.games << " positions " << stats.positions << " time "
+              << stats.time << " ms pps " << pps << " pps per core "
+              << pps / stats.threads << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,38 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tablebase.hpp>
+
+// Generates the tablebases of all endings of up to the given number of pieces
+// Usage: tbgen <directory> [pieces] [threads]
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <directory> [pieces] [threads]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string directory = argv[1];
+    const size_t pieces = (argc > 2) ? std::stoul(argv[2]) : Tablebase::MAX_PIECES;
+    const size_t threads = (argc > 3) ? std::stoul(argv[3]) : 0;
+    if (pieces < 3 || pieces > Tablebase::MAX_PIECES) {
+        std::cerr << "pieces must be between 3 and " << Tablebase::MAX_PIECES << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Each ending is timed from the report of the one before
+    auto start        = std::chrono::steady_clock::now();
+    const auto report = [&start](std::string_view name, bool generated) {
+        const auto now = std::chrono::steady_clock::now();
+        if (!generated) {
+            std::cerr << "failed to generate " << name << std::endl;
+            return;
+        }
+        std::cout << name << " "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count()
+                  << " ms" << std::endl;
+        start = now;
+    };
+    if (Tablebase::Generate(directory, pieces, threads, report) == 0) return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
@@ -1,15 +1,104 @@
+#include <algorithm>
 #include <board.hpp>
+#include <book.hpp>
+#include <charconv>
+#include <cstdint>
+#include <fen.hpp>
 #include <ios>
 #include <iostream>
+#include <mate.hpp>
+#include <memory>
+#include <nnue.hpp>
+#include <optional>
 #include <ostream>
+#include <position_command.hpp>
 #include <search.hpp>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <tablebase.hpp>
+#include <thread>
 #include <tt.hpp>
 
+namespace {
+// The search runs on its own thread, such that commands can be read while searching
+std::thread searchThread;
+std::unique_ptr<Search::SearchLimit> searchLimit;
+// The depth searched for a move once the limits are used up before any search
+// A single ply, as the move is due at once and this search cannot be stopped
+constexpr int FALLBACK_DEPTH = 1;
+
+// The position command last applied to the board
+PositionCommand::Last lastPosition;
+
+// Parses a whole number sent by the GUI, which is ignored unless valid
+// Negative numbers are read as zero, as some GUIs send a negative time once it has run out
+std::optional<size_t> Number(std::string_view value) {
+    value                = value.substr(0, value.find_last_not_of(" \t\r") + 1);
+    const char *end      = value.data() + value.size();
+    int64_t number       = 0;
+    const auto [ptr, ec] = std::from_chars(value.data(), end, number);
+    if (ec != std::errc() || ptr != end) return std::nullopt;
+    return std::max<int64_t>(0, number);
+}
+
+void StopSearch() {
+    if (searchLimit) searchLimit->Stop();
+    if (searchThread.joinable()) searchThread.join();
+}
+
+// Searches for the mate of go mate, returning the mating line if one is proven
+// The solver is given half of the limits, of which the rest is kept for the search after it
+PV SearchMate(Board &board, const Search::Limits &limits, Search::SearchLimit &limit) {
+    const size_t maxTime      = Search::TimeManager(limits, board.Turn()).Maximum();
+    const size_t maxMoveCount = limits.nodes ? board.MoveCount() + limits.nodes : SIZE_MAX;
+    limit.Start(maxTime, maxMoveCount);
+    const bool timed          = maxTime != Search::TimeManager::UNLIMITED;
+    const size_t phaseTime    = timed ? maxTime / 2 : maxTime;
+    const size_t phaseMoves   = limits.nodes ? board.MoveCount() + limits.nodes / 2 : SIZE_MAX;
+    const Mate::Result result = Mate::Solve(board, limits.mate, &limit, phaseTime, phaseMoves);
+    if (result.moves == 0) return PV();
+
+    std::string line = "info depth " + std::to_string(2 * result.moves - 1) + " score mate " +
+                       std::to_string(result.moves) + " time " + std::to_string(limit.Elapsed()) +
+                       " ms nodes " + std::to_string(result.nodes) + " pv";
+    for (const Move move : result.pv)
+        line += " " + move.Export();
+    std::cout << line + '\n' << std::flush;
+    return PV(board.Ply(), result.pv);
+}
+
+void StartSearch(Board board, Search::Limits limits, size_t multiPV) {
+    StopSearch();
+    searchLimit  = std::make_unique<Search::SearchLimit>(limits.ponder);
+    searchThread = std::thread([board, limits, multiPV, limit = searchLimit.get()]() mutable {
+        // Without a proven mate, the best move is searched for as usual, to no more plies than
+        // the mate would take
+        PV pv = limits.mate ? SearchMate(board, limits, *limit) : PV();
+        if (limits.mate && !limits.depth) limits.depth = 2 * limits.mate;
+        if (pv.empty() && limit->Stopped()) {
+            // Once the limits are used up or the search is stopped, a search of a single ply and
+            // its captures still finds a move without losing material at once
+            const Move move = Search::GetBestMoveDepth(board, FALLBACK_DEPTH);
+            if (move.IsDefined()) pv = PV(board.Ply(), {move});
+        } else if (pv.empty())
+            pv = Search::GetBestMove(board, limits, *limit, multiPV);
+        // The best move may not be sent before the GUI stops an infinite or pondering search
+        limit->Wait(limits.infinite);
+        std::string line = "bestmove " + (pv.empty() ? std::string("0000") : pv[0].Export());
+        if (pv.size() > 1) line += " ponder " + pv[1].Export();
+        std::cout << line << std::endl;
+    });
+}
+} // namespace
+
 int main(int argc, char **argv) {
     TT::Init();
-    Board board = Board();
+    Board board    = Board();
+    size_t multiPV = 1;
+    // Book moves are played up to this many plies into the game
+    size_t bookDepth = 20;
+    bool bookBest    = false;
 
     std::string command;
     std::string token;
@@ -20,58 +109,111 @@ int main(int argc, char **argv) {
             break;
         else if (token == "isready")
             std::cout << "readyok" << std::endl;
-        else if (token == "uci") {
+        else if (token == "stop")
+            StopSearch();
+        else if (token == "ponderhit") {
+            if (searchLimit) searchLimit->PonderHit();
+        } else if (token == "uci") {
             std::cout << "id name " << _NAME << " v" << _VERSION << std::endl;
             std::cout << "id author " << _AUTHOR << std::endl;
             std::cout << "option name Hash type spin default 32 min 1 max 512" << std::endl;
             std::cout << "option name Threads type spin default 1 min 1 max 1" << std::endl;
+            std::cout << "option name MultiPV type spin default 1 min 1 max " << MAX_MOVES
+                      << std::endl;
+            std::cout << "option name Ponder type check default false" << std::endl;
+            std::cout << "option name EvalFile type string default <empty>" << std::endl;
+            std::cout << "option name TablebasePath type string default <empty>" << std::endl;
+            std::cout << "option name BookFile type string default <empty>" << std::endl;
+            std::cout << "option name BookBestMove type check default false" << std::endl;
+            std::cout << "option name BookDepth type spin default 20 min 0 max 200" << std::endl;
             std::cout << "uciok" << std::endl;
             std::flush(std::cout);
+        } else if (token == "setoption") {
+            StopSearch();
+            std::string name;
+            is >> std::skipws >> token;
+            while (is >> std::skipws >> token && token != "value")
+                name += (name.empty() ? "" : " ") + token;
+            // The value is the rest of the line, as it may be a path with spaces
+            std::string value;
+            std::getline(is >> std::ws, value);
+            if (name == "MultiPV") {
+                if (const auto number = Number(value))
+                    multiPV = std::clamp<size_t>(*number, 1, MAX_MOVES);
+            } else if (name == "EvalFile") {
+                // Stored evaluations are of the prior network
+                TT::Clear();
+                if (value.empty() || value == "<empty>")
+                    NNUE::Disable();
+                else if (NNUE::Load(value))
+                    std::cout << "info string loaded network " << value << std::endl;
+                else
+                    std::cout << "info string failed to load network " << value << std::endl;
+            } else if (name == "TablebasePath") {
+                const size_t found = Tablebase::Init((value == "<empty>") ? "" : value);
+                std::cout << "info string found " << found << " tablebases" << std::endl;
+            } else if (name == "BookFile") {
+                if (Book::Open((value == "<empty>") ? "" : value))
+                    std::cout << "info string opened book " << value << std::endl;
+            } else if (name == "BookBestMove")
+                bookBest = (value == "true");
+            else if (name == "BookDepth") {
+                if (const auto number = Number(value)) bookDepth = *number;
+            }
         } else if (token == "ucinewgame") {
+            StopSearch();
             TT::Clear();
         } else if (token == "position") {
-            is >> std::skipws >> token;
-            std::string fen;
-            if (token == "startpos")
-                fen = FEN_START;
-            else if (token == "fen") {
-                fen = "";
-                for (int i = 0; i < 6; i++) {
-                    is >> std::skipws >> token;
-                    fen += token + " ";
-                }
-            }
-            board = Board(fen);
-            is >> std::skipws >> token;
-            if (token == "moves") {
-                while (is >> std::skipws >> token)
-                    board.ApplyMove(
-                        Move(board.Pieces(), board.Pieces(KING), board.Pieces(PAWN), token)
-                    );
-            }
+            StopSearch();
+            const std::string_view args =
+                std::string_view(command).substr(command.find("position") + 8);
+            // An invalid position is ignored, keeping the prior one
+            if (const FEN::Error error = PositionCommand::Apply(board, args, lastPosition);
+                error != FEN::Error::None)
+                std::cout << "info string invalid fen: " << FEN::Message(error) << std::endl;
         } else if (token == "go") {
-            std::size_t time = 60000000;
-            is >> std::skipws >> token;
-            while (token != "endl") {
-                if (token == "wtime" || token == "btime") {
-                    if ((board.Turn() == WHITE && token == "wtime") ||
-                        (board.Turn() == BLACK && token == "btime")) {
-                        is >> std::skipws >> token;
-                        time = 0.05 * std::stoi(token);
-                    } else {
-                        is >> std::skipws >> token;
-                    }
-                    is >> std::skipws >> token;
-                    continue;
-                } else if (token == "winc" || token == "binc") {
-                    is >> std::skipws >> token;
-                    is >> std::skipws >> token;
-                    continue;
-                }
-                token = "endl";
+            Search::Limits limits;
+            // Sets the limit to the number which follows, unless it is invalid
+            const auto number = [&is](auto &limit) {
+                std::string value;
+                is >> std::skipws >> value;
+                if (const auto parsed = Number(value)) limit = *parsed;
+            };
+            while (is >> std::skipws >> token) {
+                if (token == "wtime")
+                    number(limits.time[WHITE]);
+                else if (token == "btime")
+                    number(limits.time[BLACK]);
+                else if (token == "winc")
+                    number(limits.inc[WHITE]);
+                else if (token == "binc")
+                    number(limits.inc[BLACK]);
+                else if (token == "movestogo")
+                    number(limits.movesToGo);
+                else if (token == "movetime")
+                    number(limits.moveTime);
+                else if (token == "depth")
+                    number(limits.depth);
+                else if (token == "nodes")
+                    number(limits.nodes);
+                else if (token == "mate")
+                    number(limits.mate);
+                else if (token == "infinite")
+                    limits.infinite = true;
+                else if (token == "ponder")
+                    limits.ponder = true;
             }
-            const Move move = Search::GetBestMoveTime(board, time);
-            std::cout << "bestmove " << move.Export() << std::endl;
+            // A move of the book is played at once, unless the search must wait for the GUI
+            const size_t gamePly = 2 * (board.FullMoveNumber() - 1) + board.Turn();
+            const bool useBook   = Book::Enabled() && gamePly < bookDepth && !limits.infinite &&
+                                 !limits.ponder;
+            const Move bookMove = useBook ? Book::Probe(board, bookBest) : Move();
+            if (bookMove.IsDefined()) {
+                StopSearch();
+                std::cout << "bestmove " << bookMove.Export() << std::endl;
+            } else
+                StartSearch(board, limits, multiPV);
         }
     }
+    StopSearch();
 }
@@ -32,9 +32,9 @@ constexpr inline BB operator^(Column l, Column r) { return static_cast<BB>(l) ^
 constexpr inline BB operator&(BB bb, Column c) { return bb & static_cast<BB>(c); }
 constexpr inline BB operator|(BB bb, Column c) { return bb | static_cast<BB>(c); }
 constexpr inline BB operator^(BB bb, Column c) { return bb ^ static_cast<BB>(c); }
-constexpr inline BB operator&=(BB bb, Column c) { return bb &= static_cast<BB>(c); }
-constexpr inline BB operator|=(BB bb, Column c) { return bb |= static_cast<BB>(c); }
-constexpr inline BB operator^=(BB bb, Column c) { return bb ^= static_cast<BB>(c); }
+constexpr inline BB &operator&=(BB &bb, Column c) { return bb &= static_cast<BB>(c); }
+constexpr inline BB &operator|=(BB &bb, Column c) { return bb |= static_cast<BB>(c); }
+constexpr inline BB &operator^=(BB &bb, Column c) { return bb ^= static_cast<BB>(c); }
 constexpr inline BB operator&(Column c, Square sq) { return static_cast<BB>(c) & sq; }
 constexpr inline BB operator|(Column c, Square sq) { return static_cast<BB>(c) | sq; }
 constexpr inline BB operator^(Column c, Square sq) { return static_cast<BB>(c) ^ sq; }
@@ -48,9 +48,9 @@ constexpr inline BB operator^(Row l, Row r) { return static_cast<BB>(l) ^ static
 constexpr inline BB operator&(BB bb, Row r) { return bb & static_cast<BB>(r); }
 constexpr inline BB operator|(BB bb, Row r) { return bb | static_cast<BB>(r); }
 constexpr inline BB operator^(BB bb, Row r) { return bb ^ static_cast<BB>(r); }
-constexpr inline BB operator&=(BB bb, Row r) { return bb &= static_cast<BB>(r); }
-constexpr inline BB operator|=(BB bb, Row r) { return bb |= static_cast<BB>(r); }
-constexpr inline BB operator^=(BB bb, Row r) { return bb ^= static_cast<BB>(r); }
+constexpr inline BB &operator&=(BB &bb, Row r) { return bb &= static_cast<BB>(r); }
+constexpr inline BB &operator|=(BB &bb, Row r) { return bb |= static_cast<BB>(r); }
+constexpr inline BB &operator^=(BB &bb, Row r) { return bb ^= static_cast<BB>(r); }
 constexpr inline BB operator&(Row r, Square sq) { return static_cast<BB>(r) & sq; }
 constexpr inline BB operator|(Row r, Square sq) { return static_cast<BB>(r) | sq; }
 constexpr inline BB operator^(Row r, Square sq) { return static_cast<BB>(r) ^ sq; }
@@ -125,6 +125,25 @@ constexpr inline BB ShiftM(BB &bb, Direction dir, size_t count) {
 
 constexpr inline bool Multiple(BB bb) { return bb & (bb - 1); }
 
+// Extends each set bit north or south, up to the edge of the board
+template <Direction D>
+constexpr inline BB Fill(BB bb) {
+    static_assert(D == NORTH || D == SOUTH);
+    bb |= Shift<D>(bb);
+    bb |= Shift<D>(Shift<D>(bb));
+    bb |= Shift<D>(Shift<D>(Shift<D>(Shift<D>(bb))));
+    return bb;
+}
+
+// Returns the columns with any set bit
+constexpr inline BB FillColumns(BB bb) { return Fill<NORTH>(bb) | Fill<SOUTH>(bb); }
+
+// Returns the squares directly east and west of each set bit, without wrapping around
+constexpr inline BB Sides(BB bb) {
+    return (Shift<EAST>(bb) & ~static_cast<BB>(Column::A)) |
+           (Shift<WEST>(bb) & ~static_cast<BB>(Column::H));
+}
+
 // Defines a ray from each square in each direction
 // A ray in the northeast direction:
 // ....X
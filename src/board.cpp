@@ -1,74 +1,70 @@
 #include "board.hpp"
 #include "bit.hpp"
 #include "bitboard.hpp"
+#include "fen.hpp"
+#include "values.hpp"
 #include "zobrist.hpp"
-#include <cctype>
-#include <cstring>
-#include <sstream>
+#include <algorithm>
 
 // CONSTRUCTOR
 
-Board::Board(std::string FEN) noexcept {
-    ClearBoard();
-    // import pieces
-    for (int y = HEIGHT - 1; y >= 0; y--) {
-        int remainingSquares = WIDTH;
-        while (remainingSquares > 0) {
-            if (isdigit(FEN[0]))
-                remainingSquares -= FEN[0] - 48;
-            else {
-                const Color color = islower(FEN[0]) ? BLACK : WHITE;
-                const Piece piece = ToPiece(FEN[0]);
-                assert(piece != PIECE_NONE);
-                const Square sq = static_cast<Square>(8 * y + WIDTH - remainingSquares--);
-                PlacePiece(color, piece, sq);
-            }
-            FEN.erase(0, 1);
-        }
-        FEN.erase(0, 1);
-    }
-
-    this->turn = tolower(FEN[0]) == 'w' ? WHITE : BLACK;
-
-    FEN.erase(0, 2);
-    std::array<Castling, COLOR_COUNT> &castling = this->history[0].castling;
+Board::Board(std::string_view fen) noexcept : move_count(0) {
+    [[maybe_unused]] const FEN::Result result = FEN::Parse(fen, this->position);
+    assert(result.error == FEN::Error::None);
+    this->game_ply = 2 * (result.fullMove - 1) + (Turn() == BLACK);
+    this->history.reserve(MAX_PLY);
+}
 
-    while (FEN[0] != ' ' && !FEN.empty()) {
-        switch (FEN[0]) {
-        case 'K':
-        case 'k': castling[!!islower(FEN[0])] |= Castling::King; break;
-        case 'Q':
-        case 'q': castling[!!islower(FEN[0])] |= Castling::Queen; break;
-        case '-': break;
-        }
-        FEN.erase(0, 1);
+Board::Board(std::string_view fen, std::string_view moves) noexcept {
+    *this = Board(fen);
+    // The moves of the game are kept in the history as well as those of any search after them
+    this->history.reserve(MAX_PLY + std::count(moves.begin(), moves.end(), ' ') + 1);
+    while (!moves.empty()) {
+        const size_t end = std::min(moves.find(' '), moves.size());
+        if (end > 0) ApplyMove(Move(Pieces(), Pieces(KING), Pieces(PAWN), moves.substr(0, end)));
+        moves.remove_prefix(std::min(end + 1, moves.size()));
     }
-    FEN.erase(0, 1);
 }
 
-Board::Board(const std::string &FEN, const std::string &moves) noexcept {
-    *this = Board(FEN);
-    std::istringstream ss(moves);
-    std::string s;
-    while (std::getline(ss, s, ' '))
-        ApplyMove(Move(Pieces(), Pieces(KING), Pieces(PAWN), s));
+Board::Board(const Position &position, size_t fullMove) noexcept
+    : position(position), move_count(0),
+      game_ply(2 * (std::max<size_t>(fullMove, 1) - 1) + (position.turn == BLACK)) {
+    this->history.reserve(MAX_PLY);
 }
 
+Board::Board(const Board &other) noexcept
+    : position(other.position), move_count(other.move_count), game_ply(other.game_ply),
+      accumulator_ply(other.Ply()) {
+    this->history.reserve(MAX_PLY + other.history.size());
+    this->history = other.history;
+    if (other.accumulator_ply <= this->accumulator_ply &&
+        this->accumulator_ply - other.accumulator_ply < other.accumulators.size())
+        this->accumulators.push_back(
+            other.accumulators[this->accumulator_ply - other.accumulator_ply]
+        );
+}
+
+Board &Board::operator=(const Board &other) noexcept { return *this = Board(other); }
+
 // ACCESS
 
 size_t Board::MoveCount() const noexcept { return this->move_count; }
-size_t Board::Ply() const noexcept { return this->ply; }
-Color Board::Turn() const noexcept { return this->turn; }
-Square Board::EP() const noexcept { return this->history[ply].ep; }
-Castling Board::GetCastling(Color color) const noexcept {
-    return this->history[ply].castling[color];
-}
-uint64_t Board::GetHash() const noexcept { return this->history[ply].hash; }
+size_t Board::Ply() const noexcept { return this->history.size(); }
+size_t Board::HalfMoveClock() const noexcept { return this->position.halfmove; }
+size_t Board::FullMoveNumber() const noexcept { return (this->game_ply + Ply()) / 2 + 1; }
+Color Board::Turn() const noexcept { return static_cast<Color>(this->position.turn); }
+Square Board::EP() const noexcept { return static_cast<Square>(this->position.ep); }
+Castling Board::GetCastling(Color color) const noexcept { return this->position.castling[color]; }
+uint64_t Board::GetHash() const noexcept { return this->position.hash; }
+uint64_t Board::GetPawnHash() const noexcept { return this->position.pawn_hash; }
+uint64_t Board::GetMaterialHash() const noexcept { return this->position.material_hash; }
 BB Board::Pieces() const noexcept { return Pieces(WHITE) | Pieces(BLACK); };
-BB Board::Pieces(Piece piece) const noexcept { return this->pieces[piece]; }
-BB Board::Pieces(Color color) const noexcept { return this->colors[color]; }
+BB Board::Pieces(Piece piece) const noexcept { return this->position.pieces[piece]; }
+BB Board::Pieces(Color color) const noexcept { return this->position.colors[color]; }
 BB Board::Pieces(Color color, Piece piece) const noexcept { return Pieces(color) & Pieces(piece); }
-Piece Board::SquarePiece(Square square) const noexcept { return this->square_pieces[square]; }
+Piece Board::SquarePiece(Square square) const noexcept {
+    return static_cast<Piece>(this->position.squares[square]);
+}
 Color Board::SquareColor(Square square) const noexcept {
     if (square & Pieces(WHITE)) return WHITE;
     if (square & Pieces(BLACK)) return BLACK;
@@ -147,55 +143,146 @@ BB Board::GenerateAttacks(Color color) const noexcept {
     return attacks;
 }
 
-bool Board::IsThreefold() const noexcept {
-    for (size_t i = 0; i < ply; i++)
-        if (history[i].hash == history[ply].hash) return true;
+bool Board::IsThreefold() const noexcept { return IsRepetition(0); }
+
+bool Board::IsRepetition(size_t recent) const noexcept {
+    // Positions before the last capture or pawn move cannot reoccur, nor can those with the
+    // other side to move or the one two plies ago, as both sides have moved a piece since
+    const size_t ply  = this->history.size();
+    const size_t last = std::min<size_t>(this->position.halfmove, ply);
+    bool repeated     = false;
+    for (size_t i = 4; i <= last; i += 2) {
+        if (this->history[ply - i].hash != this->position.hash) continue;
+        if (repeated || i <= recent) return true;
+        repeated = true;
+    }
+    return false;
+}
+
+bool Board::IsRepetitionUpcoming(size_t recent) const noexcept {
+    // The positions of an odd number of plies ago have the other side to move, such that a single
+    // move can reach them
+    const size_t ply  = this->history.size();
+    const size_t last = std::min({(size_t)this->position.halfmove, ply, recent});
+    for (size_t i = 3; i <= last; i += 2) {
+        const uint64_t difference = this->position.hash ^ this->history[ply - i].hash;
+        const Move move           = Zobrist::ReversibleMove(difference);
+        if (!move.IsDefined()) continue;
+        const Square from = move.Origin();
+        const Square to   = move.Destination();
+        // The table holds the move in one direction only, for both colors
+        const Square piece = (Pieces() & from) ? from : to;
+        if (!(Pieces(Turn()) & piece)) continue;
+        // Knights jump, whereas any other piece needs an empty path
+        if (ATTACKS[KNIGHT][from] & to) return true;
+        if (!((Ray(from, to) ^ XRAYS[from][to] ^ to) & Pieces())) return true;
+    }
     return false;
 }
 
+bool Board::IsFiftyMoves() const noexcept { return this->position.halfmove >= 100; }
+
+Score Board::GetPieceSquare() const noexcept { return this->position.psq; }
+
+int Board::GetPhase() const noexcept { return this->position.phase; }
+
+const Position &Board::GetPosition() const noexcept { return this->position; }
+
+NNUE::Accumulator &Board::AccumulatorAt(size_t ply) const noexcept {
+    // A copy may undo moves played before it was made, from which the layers are kept anew
+    if (ply < this->accumulator_ply) {
+        this->accumulators.clear();
+        this->accumulator_ply = ply;
+    }
+    const size_t index = ply - this->accumulator_ply;
+    if (this->accumulators.size() <= index) this->accumulators.resize(index + 1);
+    return this->accumulators[index];
+}
+
+const NNUE::Accumulator &Board::GetAccumulator() const noexcept {
+    NNUE::Accumulator &accumulator = AccumulatorAt(Ply());
+    if (!accumulator.computed || accumulator.hash != this->position.hash)
+        NNUE::Refresh(accumulator, this->position);
+    return accumulator;
+}
+
 // MODIFIERS
 
 void Board::ClearBoard() {
-    memset(this, 0, sizeof(Board));
-    for (size_t i = 0; i < MAX_PLY; i++) {
-        this->history[i].ep       = SQUARE_NONE;
-        this->history[i].captured = PIECE_NONE;
-        this->history[i].hash     = 0;
-    }
-    for (const auto sq : SQUARES)
-        this->square_pieces[sq] = PIECE_NONE;
+    this->position   = Position();
+    this->move_count = 0;
+    this->game_ply   = 0;
+    this->history.clear();
+    this->accumulators.clear();
+    this->accumulator_ply    = 0;
+    this->accumulator_update = nullptr;
 }
 
 void Board::FlipPiece(Color color, Piece piece, Square square) noexcept {
     assert(color != COLOR_NONE);
     assert(piece != PIECE_NONE);
     assert(square != SQUARE_NONE);
-    this->colors[color] ^= square;
-    this->pieces[piece] ^= square;
-    Zobrist::FlipSquare(this->history[ply].hash, square, piece, color);
+    this->position.colors[color] ^= square;
+    this->position.pieces[piece] ^= square;
+    Zobrist::FlipSquare(this->position.hash, square, piece, color);
+    if (piece == PAWN) Zobrist::FlipSquare(this->position.pawn_hash, square, piece, color);
 }
 void Board::PlacePiece(Color color, Piece piece, Square square) noexcept {
     FlipPiece(color, piece, square);
-    this->square_pieces[square] = piece;
+    Zobrist::AddMaterial(this->position.material_hash, piece, color);
+    const int sign = (color == WHITE) ? 1 : -1;
+    this->position.psq += Values::PSQ[color][piece][square] * sign;
+    this->position.phase += Values::PHASE_INC[piece];
+    this->position.squares[square] = piece;
+    if (this->accumulator_update) NNUE::Add(*this->accumulator_update, color, piece, square);
 }
 void Board::RemovePiece(Color color, Piece piece, Square square) noexcept {
     FlipPiece(color, piece, square);
-    this->square_pieces[square] = PIECE_NONE;
+    Zobrist::RemoveMaterial(this->position.material_hash, piece, color);
+    const int sign = (color == WHITE) ? 1 : -1;
+    this->position.psq -= Values::PSQ[color][piece][square] * sign;
+    this->position.phase -= Values::PHASE_INC[piece];
+    this->position.squares[square] = PIECE_NONE;
+    if (this->accumulator_update) NNUE::Sub(*this->accumulator_update, color, piece, square);
+}
+void Board::MovePiece(Color color, Piece piece, Square from, Square to) noexcept {
+    FlipPiece(color, piece, from);
+    FlipPiece(color, piece, to);
+    const int sign = (color == WHITE) ? 1 : -1;
+    this->position.psq += (Values::PSQ[color][piece][to] - Values::PSQ[color][piece][from]) * sign;
+    this->position.squares[from] = PIECE_NONE;
+    this->position.squares[to]   = piece;
+    if (this->accumulator_update) {
+        NNUE::Sub(*this->accumulator_update, color, piece, from);
+        NNUE::Add(*this->accumulator_update, color, piece, to);
+    }
 }
 void Board::ApplyMove(Move move) noexcept {
-    this->ply++;
-    this->history[ply].castling = this->history[ply - 1].castling;
-    this->history[ply].hash     = this->history[ply - 1].hash;
-    const Color us              = Turn();
-    const Color nus             = ~us;
-    const Square ori            = move.Origin();
-    const Square dst            = move.Destination();
-    Piece piece                 = SquarePiece(ori);
-    Piece target                = PIECE_NONE;
-    Square target_square        = dst;
-    Square ep                   = SQUARE_NONE;
-
-    RemovePiece(us, piece, ori);
+    // The hidden layers of the next ply start from those of the current one
+    if (NNUE::Enabled()) {
+        // Both plies are kept before either is referred to, as keeping one may move the other
+        const size_t ply = Ply();
+        AccumulatorAt(ply);
+        NNUE::Accumulator &next  = AccumulatorAt(ply + 1);
+        next.values              = GetAccumulator().values;
+        this->accumulator_update = &next;
+    }
+    this->history.push_back(PlyInfo{
+        .hash     = position.hash,
+        .ep       = position.ep,
+        .castling = position.castling,
+        .captured = PIECE_NONE,
+        .halfmove = position.halfmove,
+    });
+    const Color us       = Turn();
+    const Color nus      = ~us;
+    const Square ori     = move.Origin();
+    const Square dst     = move.Destination();
+    const Piece moved    = SquarePiece(ori);
+    Piece piece          = moved;
+    Piece target         = PIECE_NONE;
+    Square target_square = dst;
+    Square ep            = SQUARE_NONE;
 
     switch (move.GetType()) {
     case Move::KingCastle:
@@ -205,8 +292,7 @@ void Board::ApplyMove(Move move) noexcept {
         const bool king_side        = dst > ori;
         const Square rook_ori       = ROOK_ORI[king_side][us];
         const Square rook_dst       = ROOK_DST[king_side][us];
-        RemovePiece(us, ROOK, rook_ori);
-        PlacePiece(us, ROOK, rook_dst);
+        MovePiece(us, ROOK, rook_ori, rook_dst);
         break;
     }
     case Move::NPromotion: piece = KNIGHT; break;
@@ -218,54 +304,79 @@ void Board::ApplyMove(Move move) noexcept {
     case Move::RPromotionCapture: piece = ROOK; goto CAPTURE;
     case Move::QPromotionCapture: piece = QUEEN; goto CAPTURE;
     case Move::EPCapture:
-        target_square = static_cast<Square>(this->history[ply - 1].ep + (us == WHITE ? -8 : 8));
+        target_square = static_cast<Square>(EP() + (us == WHITE ? -8 : 8));
     case Move::Capture: {
     CAPTURE:
         target = SquarePiece(target_square);
         RemovePiece(nus, target, target_square);
         if (target_square == CORNER_A[nus])
-            this->history[ply].castling[nus] &= Castling::King;
+            this->position.castling[nus] &= Castling::King;
         else if (target_square == CORNER_H[nus])
-            this->history[ply].castling[nus] &= Castling::Queen;
+            this->position.castling[nus] &= Castling::Queen;
         break;
     }
     case Move::DoublePawnPush: ep = static_cast<Square>((us == WHITE) ? ori + 8 : ori - 8); break;
     default: break;
     }
 
-    PlacePiece(us, piece, dst);
+    // Material only changes by captures and promotions
+    if (piece == moved)
+        MovePiece(us, piece, ori, dst);
+    else {
+        RemovePiece(us, moved, ori);
+        PlacePiece(us, piece, dst);
+    }
 
     if (piece == KING) [[unlikely]]
-        this->history[ply].castling[us] = Castling::None;
+        this->position.castling[us] = Castling::None;
     else if (piece == ROOK) [[unlikely]] {
         if (ori == CORNER_A[us])
-            this->history[ply].castling[us] &= Castling::King;
+            this->position.castling[us] &= Castling::King;
         else if (ori == CORNER_H[us])
-            this->history[ply].castling[us] &= Castling::Queen;
+            this->position.castling[us] &= Castling::Queen;
     }
 
-    if (auto p_ep = this->history[ply - 1].ep; p_ep != ep) {
-        Zobrist::FlipEnPassant(this->history[ply].hash, ep);
-        Zobrist::FlipEnPassant(this->history[ply].hash, p_ep);
+    if (auto p_ep = EP(); p_ep != ep) {
+        Zobrist::FlipEnPassant(this->position.hash, ep);
+        Zobrist::FlipEnPassant(this->position.hash, p_ep);
+    }
+    for (const Color color : {WHITE, BLACK}) {
+        const Castling p_castling = this->history.back().castling[color];
+        if (const Castling castling = this->position.castling[color]; p_castling != castling) {
+            Zobrist::FlipCastling(this->position.hash, color, castling);
+            Zobrist::FlipCastling(this->position.hash, color, p_castling);
+        }
     }
 
     this->move_count++;
-    this->history[ply].ep       = ep;
-    this->history[ply].captured = target;
-    this->turn                  = ~this->Turn();
-    Zobrist::FlipColor(this->history[ply].hash);
+    this->history.back().captured = target;
+    this->position.ep             = ep;
+    this->position.turn           = nus;
+    this->position.halfmove =
+        (moved == PAWN || target != PIECE_NONE) ? 0 : this->position.halfmove + 1;
+    Zobrist::FlipColor(this->position.hash);
+
+    if (this->accumulator_update) {
+        this->accumulator_update->hash     = this->position.hash;
+        this->accumulator_update->computed = true;
+        this->accumulator_update           = nullptr;
+    }
 }
 void Board::UndoMove(Move move) noexcept {
-    this->turn           = ~this->Turn();
-    const Color us       = Turn();
+    const PlyInfo &info  = this->history.back();
+    const Color us       = ~Turn();
     const Color nus      = ~us;
     const Square ori     = move.Origin();
     const Square dst     = move.Destination();
-    Piece piece          = SquarePiece(dst);
-    Piece target         = this->history[ply].captured;
+    const Piece piece    = SquarePiece(dst);
+    const Piece target   = static_cast<Piece>(info.captured);
     Square target_square = dst;
 
-    RemovePiece(us, piece, dst);
+    if (move.IsPromotion()) {
+        RemovePiece(us, piece, dst);
+        PlacePiece(us, PAWN, ori);
+    } else
+        MovePiece(us, piece, dst, ori);
 
     switch (move.GetType()) {
     case Move::KingCastle:
@@ -275,20 +386,15 @@ void Board::UndoMove(Move move) noexcept {
         const bool king_side        = dst > ori;
         const Square rook_ori       = ROOK_ORI[king_side][us];
         const Square rook_dst       = ROOK_DST[king_side][us];
-        RemovePiece(us, ROOK, rook_dst);
-        PlacePiece(us, ROOK, rook_ori);
+        MovePiece(us, ROOK, rook_dst, rook_ori);
         break;
     }
-    case Move::NPromotion:
-    case Move::BPromotion:
-    case Move::RPromotion:
-    case Move::QPromotion: piece = PAWN; break;
     case Move::NPromotionCapture:
     case Move::BPromotionCapture:
     case Move::RPromotionCapture:
-    case Move::QPromotionCapture: piece = PAWN; goto CAPTURE;
+    case Move::QPromotionCapture: goto CAPTURE;
     case Move::EPCapture:
-        target_square = static_cast<Square>(this->history[ply - 1].ep + (us == WHITE ? -8 : 8));
+        target_square = static_cast<Square>(info.ep + (us == WHITE ? -8 : 8));
     case Move::Capture:
     CAPTURE:
         PlacePiece(nus, target, target_square);
@@ -296,6 +402,10 @@ void Board::UndoMove(Move move) noexcept {
     default: break;
     }
 
-    PlacePiece(us, piece, ori);
-    this->ply--;
+    this->position.turn     = us;
+    this->position.ep       = info.ep;
+    this->position.castling = info.castling;
+    this->position.hash     = info.hash;
+    this->position.halfmove = info.halfmove;
+    this->history.pop_back();
 }
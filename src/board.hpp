@@ -1,16 +1,28 @@
 #pragma once
 
 #include "move.hpp"
+#include "nnue.hpp"
+#include "position.hpp"
 #include "types.hpp"
+#include <string_view>
+#include <vector>
 
 class Board {
 public:
     // CONSTRUCTOR
 
-    // Creates a board equvilant to the given FEN string
-    Board(std::string FEN = FEN_START) noexcept;
+    // Creates a board equvilant to the given FEN string, which must be valid
+    Board(std::string_view fen = FEN_START) noexcept;
     // Creates a board from a FEN string, then applies a sequence of moves
-    Board(const std::string &FEN, const std::string &moves) noexcept;
+    Board(std::string_view fen, std::string_view moves) noexcept;
+    // Creates a board of the position, as reached by the given full move number
+    Board(const Position &position, size_t fullMove = 1) noexcept;
+    // Copies only the hidden layers of the current ply, of which those of others are computed once
+    // needed
+    Board(const Board &other) noexcept;
+    Board &operator=(const Board &other) noexcept;
+    Board(Board &&other) noexcept            = default;
+    Board &operator=(Board &&other) noexcept = default;
 
     // ACCESS
 
@@ -18,6 +30,10 @@ public:
     size_t MoveCount() const noexcept;
     // Returns the number of moves currently applied
     size_t Ply() const noexcept;
+    // Returns the number of plies since the last capture or pawn move
+    size_t HalfMoveClock() const noexcept;
+    // Returns the full move number, as it would be written in a FEN string
+    size_t FullMoveNumber() const noexcept;
     // Returns the color whose turn it is
     Color Turn() const noexcept;
     // Returns the square upon which EP capture is legal
@@ -27,6 +43,10 @@ public:
     Castling GetCastling(Color color) const noexcept;
     // Returns the current position's hash
     uint64_t GetHash() const noexcept;
+    // Returns the hash of the current pawn structure
+    uint64_t GetPawnHash() const noexcept;
+    // Returns the hash of the current material, regardless of piece placement
+    uint64_t GetMaterialHash() const noexcept;
     // Returns all pieces
     BB Pieces() const noexcept;
     // Returns pieces of type
@@ -43,7 +63,26 @@ public:
     bool IsKingSafe(Color color) const noexcept;
     // Returns an attack bitboard
     BB GenerateAttacks(Color color) const noexcept;
+    // Returns whether the position has occurred twice before, i.e. a threefold repetition
     bool IsThreefold() const noexcept;
+    // Returns whether the position is a repetition, counting a single earlier occurrence if it
+    // is within the last `recent` plies, for instance those of the current search
+    bool IsRepetition(size_t recent) const noexcept;
+    // Returns whether the side to move can repeat a position within the last `recent` plies,
+    // by a single move of a piece other than a pawn
+    bool IsRepetitionUpcoming(size_t recent) const noexcept;
+    // Returns whether a draw can be claimed by the fifty move rule
+    // Does not account for the position being checkmate
+    bool IsFiftyMoves() const noexcept;
+    // Returns the piece square values, white's minus black's
+    Score GetPieceSquare() const noexcept;
+    // Returns the game phase of the pieces on the board, which is 24 at the start
+    int GetPhase() const noexcept;
+    // Returns the state of the current position
+    const Position &GetPosition() const noexcept;
+    // Returns the hidden layers of the network for the current position, computing them if needed
+    // Requires a network to be loaded
+    const NNUE::Accumulator &GetAccumulator() const noexcept;
 
     // MODIFIERS
 
@@ -59,19 +98,32 @@ public:
     void UndoMove(Move move) noexcept;
 
 private:
+    // The state needed to undo a move, pushed to the history as it is applied
     struct PlyInfo {
         uint64_t hash;
-        Square ep;
+        uint8_t ep;
         std::array<Castling, COLOR_COUNT> castling;
-        Piece captured;
+        uint8_t captured;
+        uint16_t halfmove;
     };
-    BB pieces[PIECE_COUNT];
-    BB colors[COLOR_COUNT];
-    Piece square_pieces[SQUARE_COUNT];
-    Color turn;
+    Position position;
     size_t move_count;
-    size_t ply;
-    PlyInfo history[MAX_PLY];
+    // Plies played before the position the board was created from, as given by the FEN string
+    size_t game_ply;
+    // Kept apart from the position, such that a copy only includes the plies played
+    // Reserved when created for the plies of a search, such that applying moves does not grow it
+    std::vector<PlyInfo> history;
+    // The hidden layers of the network, by ply from accumulator_ply, such that undoing a move needs
+    // no update
+    // Only updated by moves while a network is loaded, and otherwise computed once needed
+    mutable std::vector<NNUE::Accumulator> accumulators;
+    mutable size_t accumulator_ply = 0;
+    // The hidden layers which the pieces changed by the move being applied update
+    NNUE::Accumulator *accumulator_update = nullptr;
 
+    // Returns the hidden layers kept for the ply, which need not be computed
+    NNUE::Accumulator &AccumulatorAt(size_t ply) const noexcept;
     void FlipPiece(Color color, Piece piece, Square square) noexcept;
+    // Moves a piece between squares, without changing the material
+    void MovePiece(Color color, Piece piece, Square from, Square to) noexcept;
 };
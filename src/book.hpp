@@ -0,0 +1,34 @@
+#pragma once
+
+#include "board.hpp"
+#include "move.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Opening moves from a book of the Polyglot format, found by binary search within the memory
+// mapped file, such that nothing is loaded
+namespace Book {
+// A move of the book, along with its weight relative to the others of the position
+struct Entry {
+    Move move;
+    uint16_t weight;
+};
+
+// Maps a book, in place of any mapped before, such that an empty path unmaps it
+bool Open(const std::string &path);
+// Returns whether a book is mapped
+bool Enabled();
+// Returns the Polyglot hash of the position
+uint64_t Key(const Board &board);
+// Returns the legal moves of the book for the position
+std::vector<Entry> Moves(const Board &board);
+// Returns a move of the book for the position, or an undefined move if it has none
+// Either chooses at random by the weights of the moves, or the move of the highest weight
+Move Probe(const Board &board, bool best = false);
+
+namespace Internal {
+// Seeds the random choice of Probe, such that tests are repeatable
+void Seed(uint64_t seed);
+} // namespace Internal
+} // namespace Book
@@ -0,0 +1,121 @@
+#include "datagen.hpp"
+#include "bit.hpp"
+#include "board.hpp"
+#include "packed.hpp"
+#include "root_moves.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "values.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace Datagen {
+namespace {
+// Games not decided by then are drawn
+constexpr size_t MAX_GAME_PLIES = 400;
+
+// Plays random legal moves from the start position, starting over should the game end
+Board RandomOpening(size_t plies, std::mt19937_64 &rng) {
+    while (true) {
+        Board board;
+        for (size_t ply = 0; ply < plies; ply++) {
+            RootMoves moves(board);
+            if (moves.empty()) break;
+            board.ApplyMove(moves[rng() % moves.size()].move);
+        }
+        if (!RootMoves(board).empty()) return board;
+    }
+}
+
+// Plays a game from the board, keeping the quiet positions along the way
+// Returns the result for white
+int PlayGame(Board board, const Options &options, std::vector<Packed::Record> &records) {
+    Search::Limits limits;
+    limits.depth = options.depth;
+    limits.nodes = options.nodes;
+    for (size_t ply = 0; ply < MAX_GAME_PLIES; ply++) {
+        if (board.IsThreefold() || board.IsFiftyMoves() || popcount(board.Pieces()) == 2) return 0;
+
+        Search::SearchLimit limit;
+        const RootMove best = Search::GetBestRootMove(board, limits, limit);
+        const Color us      = board.Turn();
+        const bool check    = !board.IsKingSafe(us);
+        if (!best.move.IsDefined()) return check ? ((us == WHITE) ? -1 : 1) : 0;
+        // The move is played without a score, should the limit stop the first iteration
+        const bool scored = best.score != -Values::INF;
+        // Games are adjudicated once the search knows the winner, whose play is of little use
+        if (scored && std::abs(best.score) >= Values::KNOWN_WIN)
+            return ((best.score > 0) == (us == WHITE)) ? 1 : -1;
+
+        // Positions whose score follows from a capture, a promotion or an escape from check are not
+        // quiet, and would be scored by their static evaluation no better than by chance
+        if (scored && !check && !best.move.IsCapture() && !best.move.IsPromotion())
+            records.push_back(Packed::Pack(board, best.score));
+        board.ApplyMove(best.move);
+    }
+    return 0;
+}
+} // namespace
+
+Stats Generate(
+    const std::string &path, const Options &options,
+    const std::function<void(const Stats &)> &report
+) {
+    assert(options.depth != 0 || options.nodes != 0);
+    const auto t0      = std::chrono::steady_clock::now();
+    const auto elapsed = [t0]() -> size_t {
+        const auto t = std::chrono::steady_clock::now() - t0;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(t).count();
+    };
+    size_t threads = options.threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::clamp<size_t>(options.games, 1, threads);
+
+    Packed::Writer writer(path, true);
+    if (!writer.IsOpen()) return Stats();
+    Stats stats{.threads = threads};
+    std::mutex mutex;
+    std::atomic<size_t> next = 0;
+    const auto work          = [&](size_t thread) {
+        std::mt19937_64 rng(options.seed + thread);
+        TT::Table table;
+        TT::Init(table, options.hashSize);
+        TT::Bind(&table);
+        std::vector<Packed::Record> records;
+        while (next++ < options.games) {
+            TT::Clear();
+            records.clear();
+            const size_t plies = options.randomPlies + rng() % 2;
+            const int result   = PlayGame(RandomOpening(plies, rng), options, records);
+            for (Packed::Record &record : records)
+                record.result = result;
+
+            std::lock_guard lock(mutex);
+            writer.Write(records);
+            stats.games++;
+            stats.positions += records.size();
+            stats.time = elapsed();
+            if (report) report(stats);
+        }
+        TT::Bind(nullptr);
+        TT::Clean(table);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++)
+        workers.emplace_back(work, t);
+    work(0);
+    for (std::thread &worker : workers)
+        worker.join();
+    writer.Flush();
+    stats.time = elapsed();
+    return stats;
+}
+} // namespace Datagen
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Generates training data by games of the search against itself, of which the quiet positions
+// are kept, along with the score of the search and the result of the game
+namespace Datagen {
+struct Options {
+    size_t games   = 1000;
+    // Games played at once, of which zero means one per core
+    size_t threads = 0;
+    // Each move is searched to the depth or for the nodes, of which zero means no limit
+    // At least one of them must be given
+    size_t depth   = 0;
+    size_t nodes   = 5000;
+    // Random moves are played from the start position, before the search takes over
+    // A game may start with one more, such that either side moves first after them
+    size_t randomPlies = 8;
+    // Size of the transposition table of each game in MB
+    size_t hashSize = 16;
+    uint64_t seed   = 0;
+};
+
+struct Stats {
+    size_t games     = 0;
+    size_t positions = 0;
+    // Threads the games are played on
+    size_t threads = 0;
+    // Time since the generation started in ms
+    size_t time = 0;
+};
+
+// Plays the games, each on a thread with a search of its own, and appends the positions to the
+// file as packed records
+// The report is called after each game with the totals so far, from the thread of the game, though
+// never from two at once
+Stats Generate(
+    const std::string &path, const Options &options,
+    const std::function<void(const Stats &)> &report = nullptr
+);
+} // namespace Datagen
@@ -0,0 +1,248 @@
+#include "endgame.hpp"
+#include "bit.hpp"
+#include "bitboard.hpp"
+#include "utilities.hpp"
+#include "values.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+namespace Endgame {
+namespace {
+int Column(Square sq) { return static_cast<int>(Utilities::GetColumnIndex(sq)); }
+int Row(Square sq) { return static_cast<int>(Utilities::GetRowIndex(sq)); }
+
+// Mirrors a square by rows with 56, or by columns with 7
+Square Mirror(Square sq, int mask) { return static_cast<Square>(static_cast<int>(sq) ^ mask); }
+
+int Distance(Square a, Square b) {
+    return std::max(std::abs(Column(a) - Column(b)), std::abs(Row(a) - Row(b)));
+}
+
+// Bonus for driving the weak king towards the edge, and the kings towards each other
+int PushToEdge(Square sq) {
+    return 20 * (std::max(3 - Column(sq), Column(sq) - 4) + std::max(3 - Row(sq), Row(sq) - 4));
+}
+int PushClose(Square a, Square b) { return 140 - 20 * Distance(a, b); }
+// Bonus for driving the weak king towards a1 or h8
+int PushToCorner(Square sq) {
+    const int distance = std::min(Column(sq) + Row(sq), 14 - Column(sq) - Row(sq));
+    return 20 * (14 - distance);
+}
+
+int Count(const Position &position, Color color, Piece piece) {
+    return popcount(position.pieces[piece] & position.colors[color]);
+}
+
+Square KingSquare(const Position &position, Color color) {
+    return lsb(position.pieces[KING] & position.colors[color]);
+}
+
+int NonPawnMaterial(const Position &position, Color color) {
+    int material = 0;
+    for (const Piece piece : {KNIGHT, BISHOP, ROOK, QUEEN})
+        material += Count(position, color, piece) * Values::Material::MG[piece];
+    return material;
+}
+
+namespace KPK {
+// Indexed by the pawn, which is white and on the columns a to d of rows 2 to 7, by the kings and
+// by the side to move
+constexpr size_t SIZE = 24 * SQUARE_COUNT * SQUARE_COUNT * COLOR_COUNT;
+
+size_t Index(Color turn, Square whiteKing, Square blackKing, Square pawn) {
+    const size_t p = (Row(pawn) - 1) * 4 + Column(pawn);
+    return ((p * SQUARE_COUNT + whiteKing) * SQUARE_COUNT + blackKing) * COLOR_COUNT + turn;
+}
+
+enum Result : uint8_t { INVALID = 0, UNKNOWN = 1, DRAW = 2, WIN = 4 };
+
+Result Initial(Color turn, Square whiteKing, Square blackKing, Square pawn) {
+    const BB pawnAttacks = PAWN_ATTACKS[WHITE][pawn];
+    const Square front   = static_cast<Square>(pawn + 8);
+    if (Distance(whiteKing, blackKing) <= 1 || whiteKing == pawn || blackKing == pawn ||
+        (turn == WHITE && (pawnAttacks & blackKing)))
+        return INVALID;
+    // The pawn promotes without being captured
+    if (turn == WHITE && Row(pawn) == 6 && whiteKing != front &&
+        (Distance(blackKing, front) > 1 || Distance(whiteKing, front) == 1))
+        return WIN;
+    // Stalemate, or the pawn is captured
+    if (turn == BLACK &&
+        (!(ATTACKS[KING][blackKing] & ~(ATTACKS[KING][whiteKing] | pawnAttacks)) ||
+         (ATTACKS[KING][blackKing] & ~ATTACKS[KING][whiteKing] & pawn)))
+        return DRAW;
+    return UNKNOWN;
+}
+
+// Classifies a position by those after each move, such that white wins if any of its moves
+// wins, while black draws if any of its moves draws
+Result Step(const std::vector<uint8_t> &db, Color turn, Square wk, Square bk, Square pawn) {
+    uint8_t results = INVALID;
+    if (turn == WHITE) {
+        for (BB moves = ATTACKS[KING][wk]; moves;)
+            results |= db[Index(BLACK, lsb_pop(moves), bk, pawn)];
+        const Square front = static_cast<Square>(pawn + 8);
+        if (Row(pawn) < 6) results |= db[Index(BLACK, wk, bk, front)];
+        if (Row(pawn) == 1 && front != wk && front != bk)
+            results |= db[Index(BLACK, wk, bk, static_cast<Square>(pawn + 16))];
+        return (results & WIN) ? WIN : (results & UNKNOWN) ? UNKNOWN : DRAW;
+    }
+    for (BB moves = ATTACKS[KING][bk]; moves;)
+        results |= db[Index(WHITE, wk, lsb_pop(moves), pawn)];
+    return (results & DRAW) ? DRAW : (results & UNKNOWN) ? UNKNOWN : WIN;
+}
+
+template <typename F>
+void ForEach(F f) {
+    for (size_t p = 0; p < 24; p++) {
+        const Square pawn = static_cast<Square>(8 * (p / 4 + 1) + p % 4);
+        for (const Square wk : SQUARES)
+            for (const Square bk : SQUARES)
+                for (const Color turn : {WHITE, BLACK})
+                    f(turn, wk, bk, pawn);
+    }
+}
+
+// Retrograde analysis of every position, until none changes
+std::bitset<SIZE> Generate() {
+    std::vector<uint8_t> db(SIZE);
+    ForEach([&](Color turn, Square wk, Square bk, Square pawn) {
+        db[Index(turn, wk, bk, pawn)] = Initial(turn, wk, bk, pawn);
+    });
+    for (bool changed = true; changed;) {
+        changed = false;
+        ForEach([&](Color turn, Square wk, Square bk, Square pawn) {
+            uint8_t &result = db[Index(turn, wk, bk, pawn)];
+            if (result != UNKNOWN) return;
+            result  = Step(db, turn, wk, bk, pawn);
+            changed = changed || result != UNKNOWN;
+        });
+    }
+
+    std::bitset<SIZE> wins;
+    for (size_t i = 0; i < SIZE; i++)
+        wins[i] = (db[i] == WIN);
+    return wins;
+}
+} // namespace KPK
+
+int EvalDraw(const Position &, Color) { return 0; }
+
+// Mating material against a lone king, for which the king is driven to the edge
+int EvalKXK(const Position &position, Color strong) {
+    const Square strongKing = KingSquare(position, strong);
+    const Square weakKing   = KingSquare(position, ~strong);
+    int value               = PushToEdge(weakKing) + PushClose(strongKing, weakKing);
+    for (const Piece piece : {PAWN, KNIGHT, BISHOP, ROOK, QUEEN})
+        value += Count(position, strong, piece) * Values::Material::EG[piece];
+    return Values::KNOWN_WIN + std::min(value, Values::KNOWN_WIN);
+}
+
+// The king can only be mated in a corner of the color of the bishop
+int EvalKBNK(const Position &position, Color strong) {
+    const Square strongKing = KingSquare(position, strong);
+    Square weakKing         = KingSquare(position, ~strong);
+    const Square bishop     = lsb(position.pieces[BISHOP]);
+    if ((Column(bishop) + Row(bishop)) % 2 == 1) weakKing = Mirror(weakKing, 56);
+    return Values::KNOWN_WIN + PushClose(strongKing, weakKing) + PushToCorner(weakKing);
+}
+
+int EvalKPK(const Position &position, Color strong) {
+    const Square pawn = lsb(position.pieces[PAWN]);
+    if (!Internal::KPKWin(
+            strong, KingSquare(position, strong), pawn, KingSquare(position, ~strong),
+            static_cast<Color>(position.turn)
+        ))
+        return 0;
+    const int row = (strong == WHITE) ? Row(pawn) : 7 - Row(pawn);
+    return Values::KNOWN_WIN + Values::Material::Pawn::EG + 20 * row;
+}
+
+// An ending of the given material, such as "KBN" against "K"
+struct Known {
+    uint64_t key;
+    EvalFunction eval;
+    Color strong;
+};
+
+uint64_t MaterialKey(std::string_view strong, std::string_view weak, Color color) {
+    uint64_t key = 0;
+    for (const char c : strong)
+        Zobrist::AddMaterial(key, ToPiece(c), color);
+    for (const char c : weak)
+        Zobrist::AddMaterial(key, ToPiece(c), ~color);
+    return key;
+}
+
+const std::vector<Known> KNOWN = [] {
+    std::vector<Known> known;
+    const auto add = [&](std::string_view strong, std::string_view weak, EvalFunction eval) {
+        for (const Color color : {WHITE, BLACK})
+            known.push_back(Known{MaterialKey(strong, weak, color), eval, color});
+    };
+    add("KP", "K", EvalKPK);
+    add("KBN", "K", EvalKBNK);
+    add("K", "K", EvalDraw);
+    add("KN", "K", EvalDraw);
+    add("KB", "K", EvalDraw);
+    add("KNN", "K", EvalDraw);
+    return known;
+}();
+
+constexpr size_t MATERIAL_TABLE_SIZE = 1 << 13;
+thread_local std::vector<MaterialEntry> material_table(MATERIAL_TABLE_SIZE);
+} // namespace
+
+const MaterialEntry &Probe(const Position &position) {
+    const uint64_t key   = position.material_hash;
+    MaterialEntry &entry = material_table[key & (MATERIAL_TABLE_SIZE - 1)];
+    if (entry.key == key) return entry;
+
+    entry = MaterialEntry{.key = key};
+    for (const Known &known : KNOWN)
+        if (known.key == key) {
+            entry.eval   = known.eval;
+            entry.strong = known.strong;
+        }
+
+    for (const Color color : {WHITE, BLACK}) {
+        const int material   = NonPawnMaterial(position, color);
+        const int material_o = NonPawnMaterial(position, ~color);
+        if (!entry.eval && popcount(position.colors[~color]) == 1 &&
+            material >= Values::Material::Rook::MG) {
+            entry.eval   = EvalKXK;
+            entry.strong = color;
+        }
+        // Without pawns, an advantage of at most a minor piece rarely suffices
+        if (!Count(position, color, PAWN) &&
+            material - material_o <= Values::Material::Bishop::MG)
+            entry.scale[color] = (material < Values::Material::Rook::MG)        ? 0
+                                 : (material_o <= Values::Material::Bishop::MG) ? 4
+                                                                                 : 14;
+    }
+    return entry;
+}
+
+namespace Internal {
+bool KPKWin(Color strong, Square strongKing, Square pawn, Square weakKing, Color turn) {
+    static const std::bitset<KPK::SIZE> WINS = KPK::Generate();
+    // Seen from the strong side, with the pawn on the columns a to d
+    if (strong == BLACK) {
+        strongKing = Mirror(strongKing, 56);
+        weakKing   = Mirror(weakKing, 56);
+        pawn       = Mirror(pawn, 56);
+        turn       = ~turn;
+    }
+    if (Column(pawn) >= 4) {
+        strongKing = Mirror(strongKing, 7);
+        weakKing   = Mirror(weakKing, 7);
+        pawn       = Mirror(pawn, 7);
+    }
+    return WINS[KPK::Index(turn, strongKing, weakKing, pawn)];
+}
+} // namespace Internal
+} // namespace Endgame
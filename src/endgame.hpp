@@ -0,0 +1,34 @@
+#pragma once
+
+#include "position.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstdint>
+
+// Knowledge of endings, keyed by the material of a position
+namespace Endgame {
+// Evaluates a known ending, relative to the side with the stronger material
+using EvalFunction = int (*)(const Position &position, Color strong);
+
+// End game values are scaled in 64ths, by the side which is ahead
+constexpr int SCALE_NORMAL = 64;
+
+// What is derived from the count of each piece
+struct MaterialEntry {
+    uint64_t key = 0;
+    // The evaluation of a known ending, in place of the general one
+    EvalFunction eval = nullptr;
+    Color strong      = WHITE;
+    // Lowered for a side whose material advantage is hard or impossible to win with
+    std::array<int, COLOR_COUNT> scale{SCALE_NORMAL, SCALE_NORMAL};
+};
+
+// Returns the entry of the material of the position
+// Each thread has its own table, such that it needs no synchronisation
+const MaterialEntry &Probe(const Position &position);
+
+namespace Internal {
+// Returns whether the side with a pawn wins king and pawn versus king, with correct play
+bool KPKWin(Color strong, Square strongKing, Square pawn, Square weakKing, Color turn);
+} // namespace Internal
+} // namespace Endgame
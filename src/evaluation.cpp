@@ -1,116 +1,300 @@
 #include "evaluation.hpp"
 #include "bit.hpp"
 #include "bitboard.hpp"
+#include "endgame.hpp"
+#include "nnue.hpp"
 #include "types.hpp"
 #include "utilities.hpp"
 #include "values.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Evaluation {
 namespace {
-std::pair<int, int> CalculatePhase(const Board &board) {
-    int game_phase = 0;
+// The evaluation of a pawn structure
+struct PawnEntry {
+    uint64_t key = 0;
+    Score score;
+};
 
-    for (auto pType : PIECES) {
-        const BB pieces = board.Pieces(pType);
-        const int count = popcount(pieces);
-        game_phase += count * Values::PHASE_INC[static_cast<int>(pType)];
-    }
+// Pawn structures change rarely, such that most evaluations find theirs here
+// Each thread has its own table, such that it needs no synchronisation
+// Entries start out with the key of no pawns, for which the evaluation is zero as well
+constexpr size_t PAWN_TABLE_SIZE = 1 << 16;
+thread_local std::vector<PawnEntry> pawn_table(PAWN_TABLE_SIZE);
 
-    const int mg = std::min(24, game_phase);
-    const int eg = 24 - mg;
-    return {mg, eg};
-}
+// Complete evaluations, relative to the side to move, as positions recur across iterations and
+// transpositions
+struct EvalEntry {
+    uint64_t key  = 0;
+    int32_t value = 0;
+};
+
+constexpr size_t EVAL_TABLE_SIZE = 1 << 16;
+thread_local std::vector<EvalEntry> eval_table(EVAL_TABLE_SIZE);
+
+thread_local CacheStats stats;
 
 template <Color color>
-std::pair<int, int> EvalPieceSquare(const Board &board) {
-    const size_t colorI = static_cast<size_t>(color);
-    int mg              = 0;
-    int eg              = 0;
-
-    for (auto pType : PIECES) {
-        const size_t pieceI = static_cast<size_t>(pType);
-        for (BB pieces = board.Pieces(color, pType); pieces;) {
-            const Square piece = static_cast<Square>(lsb_pop(pieces));
-            mg += Values::MG[colorI][pieceI][static_cast<size_t>(piece)];
-            eg += Values::EG[colorI][pieceI][static_cast<size_t>(piece)];
-        }
+Score EvalPawn(const Position &position) {
+    constexpr Direction UP   = (color == WHITE) ? NORTH : SOUTH;
+    constexpr Direction DOWN = (color == WHITE) ? SOUTH : NORTH;
+    Score score;
+
+    const BB PAWNS   = position.pieces[PAWN] & position.colors[color];
+    const BB PAWNS_O = position.pieces[PAWN] & position.colors[~color];
+
+    // Doubled pawns, counted once per column
+    const BB doubled = PAWNS & Fill<UP>(Shift<UP>(PAWNS));
+    score += Values::Structure::DoubledPawn * popcount(FillColumns(doubled) & Row::Row1);
+
+    // Passed pawns, with no pawn in front of them, nor opposing pawns on adjacent columns
+    const BB front   = Fill<DOWN>(Shift<DOWN>(PAWNS));
+    const BB front_o = Fill<DOWN>(Shift<DOWN>(PAWNS_O));
+    const BB passed  = PAWNS & ~(front | front_o | Sides(front_o));
+    for (BB pawns = passed; pawns;) {
+        const Square pawn = static_cast<Square>(lsb_pop(pawns));
+        const int row     = Utilities::GetRowIndex(pawn);
+        score += Values::Structure::PassedPawn[color][static_cast<size_t>(row)];
     }
 
-    return {mg, eg};
-}
+    // Isolated pawns, with no pawns of the same color on adjacent columns
+    const BB isolated = PAWNS & ~Sides(FillColumns(PAWNS));
+    score += Values::Structure::IsolatedPawn * popcount(isolated);
 
-std::pair<int, int> EvalPieceSquare(const Board &board) {
-    const auto white = EvalPieceSquare<WHITE>(board);
-    const auto black = EvalPieceSquare<BLACK>(board);
-    return {white.first - black.first, white.second - black.second};
+    return score;
 }
 
 template <Color color>
-std::pair<int, int> EvalPawn(const Board &board) {
+Score EvalPawnLoop(const Board &board) {
     const size_t colorI    = static_cast<size_t>(color);
     static Direction UP[2] = {NORTH, SOUTH};
-    int mg                 = 0;
-    int eg                 = 0;
+    Score score;
 
     const BB PAWNS   = board.Pieces(color, PAWN);
     const BB PAWNS_O = board.Pieces(~color, PAWN);
 
     // Doubled pawns
     for (auto column : COLUMNS)
-        if (Multiple(PAWNS & static_cast<BB>(column))) {
-            mg += Values::Structure::DoubledPawn::MG;
-            eg += Values::Structure::DoubledPawn::EG;
-        }
+        if (Multiple(PAWNS & static_cast<BB>(column))) score += Values::Structure::DoubledPawn;
 
     for (BB pawns = PAWNS; pawns;) {
         const Square pawn = static_cast<Square>(lsb_pop(pawns));
         // Passed pawn check
         if (!(PawnPassMask(pawn, color) & PAWNS_O) && !(Ray(pawn, UP[colorI]) & PAWNS)) {
             const int row = Utilities::GetRowIndex(pawn);
-            mg += Values::Structure::PassedPawn::MG[colorI][static_cast<size_t>(row)];
-            eg += Values::Structure::PassedPawn::EG[colorI][static_cast<size_t>(row)];
+            score += Values::Structure::PassedPawn[colorI][static_cast<size_t>(row)];
         }
         // Isolated pawn check
-        if (!(PawnIsolationMask(pawn) & PAWNS)) {
-            mg += Values::Structure::IsolatedPawn::MG;
-            eg += Values::Structure::IsolatedPawn::EG;
+        if (!(PawnIsolationMask(pawn) & PAWNS)) score += Values::Structure::IsolatedPawn;
+    }
+
+    return score;
+}
+
+const PawnEntry &EvalPawn(const Position &position) {
+    const uint64_t key = position.pawn_hash;
+    PawnEntry &entry   = pawn_table[key & (PAWN_TABLE_SIZE - 1)];
+    stats.pawnProbes++;
+    if (entry.key == key) {
+        stats.pawnHits++;
+        return entry;
+    }
+
+    entry       = PawnEntry{.key = key};
+    entry.score = EvalPawn<WHITE>(position) - EvalPawn<BLACK>(position);
+    return entry;
+}
+
+// Batches are evaluated in blocks of positions, laid out as a structure of arrays
+constexpr size_t BATCH_BLOCK = 64;
+// Fewer positions than this are not worth a thread of their own
+constexpr size_t BATCH_PER_THREAD = 1 << 14;
+
+// The threads of batches, kept from one batch to the next, such that their caches stay filled
+class BatchWorkers {
+public:
+    ~BatchWorkers() {
+        {
+            std::lock_guard lock(_mutex);
+            _exit = true;
+        }
+        _start.notify_all();
+        for (std::thread &worker : _workers)
+            worker.join();
+    }
+
+    // Runs the work for each index below the count, the first on the calling thread and the rest
+    // on the workers, returning once all are done
+    void Run(size_t count, const std::function<void(size_t)> &work) {
+        // Batches of several threads take turns
+        std::lock_guard batch(_batch);
+        while (_workers.size() + 1 < count)
+            _workers.emplace_back(&BatchWorkers::Loop, this, _workers.size() + 1, _generation);
+        {
+            std::lock_guard lock(_mutex);
+            _work    = &work;
+            _count   = count;
+            _pending = count - 1;
+            _generation++;
         }
+        _start.notify_all();
+        work(0);
+        std::unique_lock lock(_mutex);
+        _done.wait(lock, [this] { return _pending == 0; });
     }
 
-    return {mg, eg};
+private:
+    std::vector<std::thread> _workers;
+    std::mutex _batch;
+    std::mutex _mutex;
+    std::condition_variable _start;
+    std::condition_variable _done;
+    const std::function<void(size_t)> *_work = nullptr;
+    size_t _count                            = 0;
+    size_t _pending                          = 0;
+    // Counts the batches, by which the workers tell a new one from the last
+    size_t _generation = 0;
+    bool _exit         = false;
+
+    void Loop(size_t index, size_t generation) {
+        std::unique_lock lock(_mutex);
+        while (true) {
+            _start.wait(lock, [&] { return _exit || _generation != generation; });
+            if (_exit) return;
+            generation = _generation;
+            if (index >= _count) continue;
+            lock.unlock();
+            (*_work)(index);
+            lock.lock();
+            if (--_pending == 0) _done.notify_one();
+        }
+    }
+};
+
+BatchWorkers batch_workers;
+
+// Interpolates between the middle and end game values, scaling the latter by the side ahead
+// The phase of promoted pieces may exceed that of the start, at which it is capped
+int Taper(Score score, int phase, const Endgame::MaterialEntry &material) {
+    const int mg = score.MG();
+    const int eg = score.EG() * material.scale[score.EG() > 0 ? WHITE : BLACK];
+    phase        = std::min(phase, 24);
+    return (mg * phase * Endgame::SCALE_NORMAL + eg * (24 - phase)) /
+           (24 * Endgame::SCALE_NORMAL);
 }
 
-std::pair<int, int> EvalPawn(const Board &board) {
-    const auto white = EvalPawn<WHITE>(board);
-    const auto black = EvalPawn<BLACK>(board);
-    return {white.first - black.first, white.second - black.second};
+// Positions carry their piece square sums and phase, such that these are gathered into arrays,
+// over which the tapering is vectorised
+// Known endings are evaluated apart, after which the rest is tapered at once
+void EvalBlock(const Position *positions, int *evals, size_t count) {
+    alignas(64) std::array<int32_t, BATCH_BLOCK> mgs;
+    alignas(64) std::array<int32_t, BATCH_BLOCK> egs;
+    alignas(64) std::array<int32_t, BATCH_BLOCK> phases;
+    alignas(64) std::array<int32_t, BATCH_BLOCK> signs;
+    for (size_t i = 0; i < count; i++) {
+        const Position &position               = positions[i];
+        const Endgame::MaterialEntry &material = Endgame::Probe(position);
+        const Score score                      = position.psq + EvalPawn(position).score;
+        signs[i]                               = (position.turn == WHITE) ? 1 : -1;
+        if (material.eval) {
+            const int value = material.eval(position, material.strong);
+            // Tapers to the value regardless of phase
+            mgs[i]    = value * Endgame::SCALE_NORMAL * ((material.strong == WHITE) ? 1 : -1);
+            egs[i]    = mgs[i];
+            phases[i] = 0;
+            continue;
+        }
+        mgs[i]    = score.MG() * Endgame::SCALE_NORMAL;
+        egs[i]    = score.EG() * material.scale[score.EG() > 0 ? WHITE : BLACK];
+        phases[i] = std::min(position.phase, 24);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const int value = (mgs[i] * phases[i] + egs[i] * (24 - phases[i])) /
+                          (24 * Endgame::SCALE_NORMAL);
+        evals[i]        = value * signs[i];
+    }
 }
 } // namespace
 
 int Eval(const Board &board) {
-    const std::pair<int, int> game_phase = CalculatePhase(board);
-
-    int value = 0;
+    // Evaluations of a network do not match those of another, nor those without one
+    const uint64_t key = board.GetHash() ^ NNUE::Id();
+    EvalEntry &entry   = eval_table[key & (EVAL_TABLE_SIZE - 1)];
+    stats.evalProbes++;
+    if (entry.key == key) {
+        stats.evalHits++;
+        return entry.value;
+    }
 
-    const std::pair<int, int> piece_square = EvalPieceSquare(board);
-    value += game_phase.first * piece_square.first;
-    value += game_phase.second * piece_square.second;
+    const Position &position               = board.GetPosition();
+    const Endgame::MaterialEntry &material = Endgame::Probe(position);
+    if (material.eval) {
+        const int value = material.eval(position, material.strong);
+        entry           = EvalEntry{key, (board.Turn() == material.strong) ? value : -value};
+        return entry.value;
+    }
 
-    const std::pair<int, int> pawn_structure = EvalPawn(board);
-    value += game_phase.first * pawn_structure.first;
-    value += game_phase.second * pawn_structure.second;
+    if (NNUE::Enabled()) {
+        entry = EvalEntry{key, NNUE::Evaluate(board.GetAccumulator(), board.Turn())};
+        return entry.value;
+    }
 
-    value /= 24;
+    Score score = board.GetPieceSquare();
+    score += EvalPawn(position).score;
 
-    return (board.Turn() == WHITE) ? value : -value;
+    const int value = Taper(score, board.GetPhase(), material);
+    entry           = EvalEntry{key, (board.Turn() == WHITE) ? value : -value};
+    return entry.value;
 }
 
-int EvalNoMove(const Board &board) {
+int EvalNoMove(const Board &board, int ply) {
     bool isKingSafe = board.IsKingSafe(board.Turn());
     // Checkmate
-    if (!isKingSafe) return -Values::INF;
+    if (!isKingSafe) return Values::MatedIn(ply);
     // Stalemate
     else
         return 0;
 }
+
+void EvalBatch(std::span<const Position> positions, std::span<int> evals, size_t threads) {
+    assert(evals.size() >= positions.size());
+    if (positions.empty()) return;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::clamp<size_t>(positions.size() / BATCH_PER_THREAD, 1, threads);
+
+    const auto evalRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i += BATCH_BLOCK)
+            EvalBlock(&positions[i], &evals[i], std::min(BATCH_BLOCK, end - i));
+    };
+
+    // Each thread takes a range of whole blocks, the last of which may be shorter
+    const size_t blocks = (positions.size() + BATCH_BLOCK - 1) / BATCH_BLOCK;
+    const size_t range  = (blocks + threads - 1) / threads * BATCH_BLOCK;
+    const size_t count  = (positions.size() + range - 1) / range;
+    batch_workers.Run(count, [&](size_t i) {
+        evalRange(i * range, std::min((i + 1) * range, positions.size()));
+    });
+}
+
+CacheStats GetCacheStats() { return stats; }
+void ResetCacheStats() { stats = CacheStats(); }
+
+namespace Internal {
+Score EvalPawns(const Board &board) {
+    const Position &position = board.GetPosition();
+    return EvalPawn<WHITE>(position) - EvalPawn<BLACK>(position);
+}
+
+Score EvalPawnsLoop(const Board &board) {
+    return EvalPawnLoop<WHITE>(board) - EvalPawnLoop<BLACK>(board);
+}
+} // namespace Internal
 } // namespace Evaluation
@@ -1,8 +1,32 @@
 #pragma once
 
 #include "board.hpp"
+#include <span>
 
 namespace Evaluation {
+// Probes and hits of the caches behind Eval, counted for the calling thread
+struct CacheStats {
+    size_t evalProbes = 0;
+    size_t evalHits   = 0;
+    size_t pawnProbes = 0;
+    size_t pawnHits   = 0;
+};
+
 int Eval(const Board &board);
-int EvalNoMove(const Board &board);
+// Evaluates a position without legal moves, mated at the given ply or stalemated
+int EvalNoMove(const Board &board, int ply);
+// Evaluates a batch of positions as Eval does without a network, relative to the side to move
+// Large batches are split between threads, of which zero means one per core
+// The threads are kept for later batches, along with their caches
+void EvalBatch(std::span<const Position> positions, std::span<int> evals, size_t threads = 0);
+
+CacheStats GetCacheStats();
+void ResetCacheStats();
+
+namespace Internal {
+// Returns the pawn structure score of white minus black, without the pawn table
+Score EvalPawns(const Board &board);
+// Same as EvalPawns, though evaluating pawn by pawn, as a reference for it
+Score EvalPawnsLoop(const Board &board);
+} // namespace Internal
 } // namespace Evaluation
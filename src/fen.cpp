@@ -0,0 +1,205 @@
+#include "fen.hpp"
+#include "bit.hpp"
+#include "bitboard.hpp"
+#include <algorithm>
+#include <charconv>
+#include <fcntl.h>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace FEN {
+namespace {
+// Files are split between threads in chunks of at least this many bytes
+constexpr size_t MIN_CHUNK = 1 << 20;
+
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+// Parses the lines of a chunk into consecutive positions, marking those which are valid
+// Returns the number of invalid lines
+size_t ParseChunk(std::string_view chunk, Position *positions, uint8_t *valid) {
+    size_t errors = 0;
+    for (size_t line = 0; !chunk.empty(); line++) {
+        const size_t end           = std::min(chunk.find('\n'), chunk.size());
+        const std::string_view fen = chunk.substr(0, end);
+        chunk.remove_prefix(std::min(end + 1, chunk.size()));
+        if (std::all_of(fen.begin(), fen.end(), IsSpace)) continue;
+        valid[line] = Parse(fen, positions[line]).error == Error::None;
+        errors += !valid[line];
+    }
+    return errors;
+}
+} // namespace
+
+Result Parse(std::string_view fen, Position &position) {
+    position        = Position();
+    size_t i        = 0;
+    const auto fail = [&i](Error error) { return Result{error, i}; };
+    // Skips the spaces before the next field, returning whether there is one
+    const auto next = [&]() {
+        const size_t start = i;
+        while (i < fen.size() && IsSpace(fen[i]))
+            i++;
+        return i > start && i < fen.size();
+    };
+    const auto ended = [&]() { return i == fen.size() || IsSpace(fen[i]); };
+
+    // The rows are given from the eighth to the first
+    for (int y = HEIGHT - 1; y >= 0; y--) {
+        size_t x = 0;
+        for (; i < fen.size() && fen[i] != '/' && !IsSpace(fen[i]); i++) {
+            if (fen[i] >= '1' && fen[i] <= '8') {
+                x += fen[i] - '0';
+                if (x > WIDTH) return fail(Error::Placement);
+                continue;
+            }
+            const Piece piece = ToPiece(fen[i]);
+            if (piece == PIECE_NONE || x == WIDTH) return fail(Error::Placement);
+            const Color color = (fen[i] >= 'a') ? BLACK : WHITE;
+            PlacePiece(position, color, piece, static_cast<Square>(8 * y + x++));
+        }
+        if (x != WIDTH || (y > 0 && (i == fen.size() || fen[i++] != '/')))
+            return fail(Error::Placement);
+    }
+    // Each side has a single king, and no pawn stands where it could never have been
+    for (const Color color : {WHITE, BLACK})
+        if (popcount(position.pieces[KING] & position.colors[color]) != 1)
+            return fail(Error::Placement);
+    if (position.pieces[PAWN] & (Row::Row1 | Row::Row8)) return fail(Error::Placement);
+
+    if (!next() || (fen[i] != 'w' && fen[i] != 'b')) return fail(Error::Turn);
+    const Color turn = (fen[i++] == 'w') ? WHITE : BLACK;
+    if (!ended()) return fail(Error::Turn);
+
+    if (!next()) return fail(Error::Castling);
+    std::array<Castling, COLOR_COUNT> castling = {Castling::None, Castling::None};
+    if (fen[i] == '-')
+        i++;
+    else
+        for (; !ended(); i++) {
+            switch (fen[i]) {
+            case 'K': castling[WHITE] |= Castling::King; break;
+            case 'Q': castling[WHITE] |= Castling::Queen; break;
+            case 'k': castling[BLACK] |= Castling::King; break;
+            case 'q': castling[BLACK] |= Castling::Queen; break;
+            default: return fail(Error::Castling);
+            }
+        }
+    if (!ended()) return fail(Error::Castling);
+    // A right to castle needs the king and the rook on the squares they start from
+    for (const Color color : {WHITE, BLACK}) {
+        const BB king  = position.pieces[KING] & position.colors[color];
+        const BB rooks = position.pieces[ROOK] & position.colors[color];
+        if (castling[color] != Castling::None && !(king & INIT_KINGPOS[color]))
+            return fail(Error::Castling);
+        if ((castling[color] & Castling::King) != Castling::None &&
+            !(rooks & INIT_ROOKPOS[color][0]))
+            return fail(Error::Castling);
+        if ((castling[color] & Castling::Queen) != Castling::None &&
+            !(rooks & INIT_ROOKPOS[color][1]))
+            return fail(Error::Castling);
+    }
+
+    if (!next()) return fail(Error::EnPassant);
+    Square ep = SQUARE_NONE;
+    if (fen[i] == '-')
+        i++;
+    else {
+        const char row = (turn == WHITE) ? '6' : '3';
+        if (fen[i] < 'a' || fen[i] > 'h' || i + 1 == fen.size() || fen[i + 1] != row)
+            return fail(Error::EnPassant);
+        ep = static_cast<Square>(8 * (fen[i + 1] - '1') + fen[i] - 'a');
+        i += 2;
+    }
+    if (!ended()) return fail(Error::EnPassant);
+    SetState(position, turn, castling, ep);
+
+    // The move counters are optional, as they are often left out of EPD strings, where operations
+    // may follow instead
+    Result result{Error::None, i};
+    size_t counters[2] = {0, 1};
+    for (size_t &counter : counters) {
+        if (!next() || fen[i] < '0' || fen[i] > '9') break;
+        const auto parsed = std::from_chars(fen.data() + i, fen.data() + fen.size(), counter);
+        i                 = parsed.ptr - fen.data();
+        if (parsed.ec != std::errc() || !ended()) return fail(Error::Counters);
+        result.offset = i;
+    }
+    position.halfmove = std::min<size_t>(counters[0], UINT16_MAX);
+    result.fullMove   = std::max<size_t>(counters[1], 1);
+    return result;
+}
+
+std::string_view Message(Error error) {
+    switch (error) {
+    case Error::None: return "valid";
+    case Error::Placement: return "invalid piece placement";
+    case Error::Turn: return "invalid side to move";
+    case Error::Castling: return "invalid castling rights";
+    case Error::EnPassant: return "invalid en passant square";
+    case Error::Counters: return "invalid move counters";
+    }
+    return "";
+}
+
+Batch Load(const std::string &path, size_t threads) {
+    Batch batch;
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return batch;
+    struct stat status;
+    void *address = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+        address = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) return batch;
+    madvise(address, status.st_size, MADV_SEQUENTIAL);
+    const std::string_view file(static_cast<const char *>(address), status.st_size);
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::clamp<size_t>(file.size() / MIN_CHUNK, 1, threads);
+    // Chunks are split after the line break following an even share of the file
+    std::vector<size_t> bounds = {0};
+    for (size_t t = 1; t < threads; t++) {
+        const size_t split = file.find('\n', std::max(t * file.size() / threads, bounds.back()));
+        bounds.push_back((split == std::string_view::npos) ? file.size() : split + 1);
+    }
+    bounds.push_back(file.size());
+    const auto chunk = [&](size_t t) {
+        return file.substr(bounds[t], bounds[t + 1] - bounds[t]);
+    };
+    const auto parallel = [threads](auto work) {
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; t++)
+            workers.emplace_back(work, t);
+        work(0);
+        for (auto &worker : workers)
+            worker.join();
+    };
+
+    // Lines are counted first, such that each chunk parses into its own range of the positions
+    std::vector<size_t> lines(threads + 1, 0);
+    parallel([&](size_t t) {
+        const std::string_view text = chunk(t);
+        const bool unterminated     = !text.empty() && text.back() != '\n';
+        lines[t + 1]                = std::count(text.begin(), text.end(), '\n') + unterminated;
+    });
+    std::partial_sum(lines.begin(), lines.end(), lines.begin());
+    batch.positions.resize(lines.back());
+    std::vector<uint8_t> valid(lines.back(), false);
+    std::vector<size_t> errors(threads, 0);
+    parallel([&](size_t t) {
+        errors[t] = ParseChunk(chunk(t), &batch.positions[lines[t]], &valid[lines[t]]);
+    });
+    munmap(address, status.st_size);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < batch.positions.size(); i++)
+        if (valid[i]) batch.positions[kept++] = batch.positions[i];
+    batch.positions.resize(kept);
+    for (const size_t count : errors)
+        batch.errors += count;
+    return batch;
+}
+} // namespace FEN
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "position.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reads positions of FEN and EPD strings, in a single pass and without allocating
+namespace FEN {
+// The field in which a string was found to be invalid
+enum class Error : uint8_t { None, Placement, Turn, Castling, EnPassant, Counters };
+
+struct Result {
+    Error error     = Error::None;
+    // Offset of the string past the last field read, or at which the error was found
+    // Operations of an EPD string start after it
+    size_t offset   = 0;
+    size_t fullMove = 1;
+};
+
+// Parses a string into the position, whose move counters may be left out as in EPD
+// The position is left incomplete if the string is invalid
+Result Parse(std::string_view fen, Position &position);
+// Returns a description of the error
+std::string_view Message(Error error);
+
+struct Batch {
+    // The positions of the valid lines, in the order of the file
+    std::vector<Position> positions;
+    // Lines which were not valid, and are left out, not counting empty lines
+    size_t errors = 0;
+};
+
+// Maps a file of a position per line and parses it by chunks in parallel, of which zero threads
+// means one per core
+Batch Load(const std::string &path, size_t threads = 0);
+} // namespace FEN
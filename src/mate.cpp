@@ -0,0 +1,192 @@
+#include "mate.hpp"
+#include "move_gen.hpp"
+#include "move_list.hpp"
+#include <algorithm>
+#include <array>
+
+namespace Mate {
+namespace {
+// The proof and disproof numbers of a solved position
+constexpr uint32_t INF = 1u << 30;
+
+uint32_t Add(uint32_t a, uint32_t b) { return std::min(a + b, INF); }
+
+// Numbers are relative to the side to move, such that phi is the effort to prove a win for it
+// and delta the effort to prove a loss
+struct Numbers {
+    uint32_t phi   = 1;
+    uint32_t delta = 1;
+};
+
+struct Entry {
+    uint64_t key = 0;
+    Numbers numbers;
+    // Nodes searched beneath the position, by which entries are replaced
+    uint32_t work = 0;
+};
+
+struct Child {
+    Move move;
+    uint64_t key;
+};
+
+class Solver {
+public:
+    Solver(
+        Board &board, Search::SearchLimit *limit, size_t searchTime, size_t maxMoveCount,
+        size_t tableSize
+    )
+        : board(board), limit(limit), searchTime(searchTime), maxMoveCount(maxMoveCount) {
+        size_t count = 1;
+        while (2 * count * sizeof(Bucket) <= tableSize * 1024 * 1024)
+            count *= 2;
+        table.resize(count);
+    }
+
+    // Returns the numbers of the root searched to the given number of plies, once solved or
+    // stopped
+    Numbers Prove(size_t plies) {
+        MID(plies, INF, INF, true);
+        return Lookup(Key(board.GetHash(), plies));
+    }
+
+    bool Stopped() const { return stopped; }
+
+    // Follows the moves which keep the proof, until mate
+    std::vector<Move> PV(size_t plies) {
+        std::vector<Move> pv;
+        std::array<Child, MAX_MOVES> children;
+        for (bool attacker = true; plies > 0; attacker = !attacker, plies--) {
+            const size_t count = Children(children, plies, attacker);
+            const auto proven  = std::find_if(
+                children.begin(), children.begin() + count, [&](const Child &child) {
+                    const Numbers numbers = Lookup(child.key);
+                    return attacker ? numbers.delta == 0 : numbers.phi == 0;
+                }
+            );
+            if (proven == children.begin() + count) break;
+            pv.push_back(proven->move);
+            board.ApplyMove(proven->move);
+        }
+        for (auto move = pv.rbegin(); move != pv.rend(); move++)
+            board.UndoMove(*move);
+        return pv;
+    }
+
+private:
+    using Bucket = std::array<Entry, 2>;
+
+    Board &board;
+    Search::SearchLimit *limit;
+    // The share of the limit which the solver may use
+    size_t searchTime;
+    size_t maxMoveCount;
+    std::vector<Bucket> table;
+    bool stopped = false;
+
+    // Positions are keyed by the plies remaining as well, as a mate may be out of reach with
+    // fewer, such that no position repeats along a path of decreasing plies
+    static uint64_t Key(uint64_t hash, size_t plies) {
+        return hash ^ (plies * 0x9E3779B97F4A7C15ull);
+    }
+
+    Numbers Lookup(uint64_t key) const {
+        for (const Entry &entry : table[key & (table.size() - 1)])
+            if (entry.key == key) return entry.numbers;
+        return Numbers();
+    }
+
+    void Store(uint64_t key, Numbers numbers, size_t work) {
+        // Replaces the entry of the position, or else that of less work
+        Bucket &bucket = table[key & (table.size() - 1)];
+        Entry *entry   = &bucket[0];
+        if (bucket[0].key != key && (bucket[1].key == key || bucket[1].work < bucket[0].work))
+            entry = &bucket[1];
+        *entry = Entry{key, numbers, static_cast<uint32_t>(std::min<size_t>(work, UINT32_MAX))};
+    }
+
+    // Generates the legal moves of the position, of which only checks can mate at the last ply
+    size_t Children(std::array<Child, MAX_MOVES> &children, size_t plies, bool attacker) {
+        size_t count = 0;
+        for (const Move move : GenerateMovesAll(board, board.Turn())) {
+            board.ApplyMove(move);
+            if (board.IsKingSafe(~board.Turn()) &&
+                !(attacker && plies == 1 && board.IsKingSafe(board.Turn())))
+                children[count++] = Child{move, Key(board.GetHash(), plies - 1)};
+            board.UndoMove(move);
+        }
+        return count;
+    }
+
+    // Searches the position until its numbers reach either threshold
+    void MID(size_t plies, uint32_t thPhi, uint32_t thDelta, bool attacker) {
+        const uint64_t key      = Key(board.GetHash(), plies);
+        const size_t priorMoves = board.MoveCount();
+        if (limit != nullptr && limit->Reached(board.MoveCount(), searchTime, maxMoveCount)) {
+            stopped = true;
+            return;
+        }
+
+        // Once the plies run out, only whether the defender is mated remains to be seen
+        const bool inCheck = !board.IsKingSafe(board.Turn());
+        std::array<Child, MAX_MOVES> children;
+        const size_t count =
+            (plies > 0 || (!attacker && inCheck)) ? Children(children, plies, attacker) : 0;
+        // The attacker fails without moves or plies, while the defender escapes unless mated
+        if (count == 0 || plies == 0) {
+            const bool lost = attacker || (inCheck && count == 0);
+            Store(key, lost ? Numbers{INF, 0} : Numbers{0, INF}, 0);
+            return;
+        }
+
+        Numbers numbers;
+        while (true) {
+            // The side to move wins by any child which is lost, and loses if all are won
+            size_t best          = 0;
+            uint32_t bestPhi     = 0;
+            uint32_t secondDelta = INF;
+            numbers              = Numbers{INF, 0};
+            for (size_t i = 0; i < count; i++) {
+                const Numbers child = Lookup(children[i].key);
+                if (child.delta < numbers.phi) {
+                    secondDelta = numbers.phi;
+                    numbers.phi = child.delta;
+                    best        = i;
+                    bestPhi     = child.phi;
+                } else if (child.delta < secondDelta)
+                    secondDelta = child.delta;
+                numbers.delta = Add(numbers.delta, child.phi);
+            }
+            if (numbers.phi >= thPhi || numbers.delta >= thDelta || stopped) break;
+
+            const uint32_t childPhi   = std::min(thDelta - numbers.delta + bestPhi, INF);
+            const uint32_t childDelta = std::min(thPhi, Add(secondDelta, 1));
+            board.ApplyMove(children[best].move);
+            MID(plies - 1, childPhi, childDelta, !attacker);
+            board.UndoMove(children[best].move);
+        }
+        Store(key, numbers, board.MoveCount() - priorMoves);
+    }
+};
+} // namespace
+
+Result Solve(
+    Board &board, size_t moves, Search::SearchLimit *limit, size_t searchTime, size_t maxMoveCount,
+    size_t tableSize
+) {
+    Solver solver(board, limit, searchTime, maxMoveCount, tableSize);
+    Result result;
+    const size_t priorMoves = board.MoveCount();
+    // Shorter mates are searched first, whose positions are kept for the longer ones
+    for (size_t n = 1; n <= moves && !solver.Stopped(); n++) {
+        const Numbers root = solver.Prove(2 * n - 1);
+        if (root.phi == 0 && !solver.Stopped()) {
+            result.moves = n;
+            result.pv    = solver.PV(2 * n - 1);
+            break;
+        }
+    }
+    result.nodes = board.MoveCount() - priorMoves;
+    return result;
+}
+} // namespace Mate
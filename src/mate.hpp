@@ -0,0 +1,28 @@
+#pragma once
+
+#include "board.hpp"
+#include "move.hpp"
+#include "search_limit.hpp"
+#include <cstdint>
+#include <vector>
+
+// Proves forced mates by depth-first proof-number search, which expands the move closest to a
+// proof or disproof, rather than searching every move to a fixed depth
+namespace Mate {
+struct Result {
+    // The number of moves to mate, or 0 if none was proven
+    size_t moves = 0;
+    // The mating line, in which the defending side need not play its longest defence
+    std::vector<Move> pv;
+    size_t nodes = 0;
+};
+
+// Searches for the shortest mate by the side to move within the number of moves, until the limit
+// is reached, or the solver has used its share of it, the time in ms and the total move count of
+// the board
+// Proof and disproof numbers are kept in a table of their own, of the given size in MB
+Result Solve(
+    Board &board, size_t moves, Search::SearchLimit *limit = nullptr, size_t searchTime = SIZE_MAX,
+    size_t maxMoveCount = SIZE_MAX, size_t tableSize = 16
+);
+} // namespace Mate
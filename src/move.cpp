@@ -7,7 +7,7 @@ Move::Move(Square origin, Square destination, Type type) noexcept
           (static_cast<uint16_t>(type) << 12)
       ) {}
 
-Move::Move(BB occ, BB kings, BB pawns, const std::string &move) noexcept {
+Move::Move(BB occ, BB kings, BB pawns, std::string_view move) noexcept {
     const Square ori   = Utilities::GetSquare(move[0], move[1]);
     const Square dst   = Utilities::GetSquare(move[2], move[3]);
     const bool capture = occ & dst;
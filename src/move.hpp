@@ -2,6 +2,7 @@
 
 #include "types.hpp"
 #include <string>
+#include <string_view>
 
 // A chess move. Includes information regarding origin square, destination square and type of move.
 class Move {
@@ -26,7 +27,7 @@ public:
     Move() noexcept = default;
     Move(Square origin, Square destination, Type type) noexcept;
     // Creates a move from a string in smith notation
-    Move(BB occ, BB kings, BB pawns, const std::string &move) noexcept;
+    Move(BB occ, BB kings, BB pawns, std::string_view move) noexcept;
 
     Square Origin() const noexcept;
     Square Destination() const noexcept;
@@ -30,7 +30,7 @@ void MVVLVA(const Board &board, MoveList &moves) {
 
 void PVPrioity(const Board &board, const PV &pv, MoveList &moves) {
     size_t pvIndex = board.Ply() - pv.ply();
-    if (pvIndex > pv.size() || pv.size() == 0) return;
+    if (pvIndex >= pv.size()) return;
     Move pvMove = pv[pvIndex];
     for (size_t i = 1; i < moves.size(); i++) {
         if (moves[i] == pvMove) {
@@ -0,0 +1,220 @@
+#include "nnue.hpp"
+#include "bit.hpp"
+#include "values.hpp"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <random>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+namespace NNUE {
+namespace {
+// Identifies the file format, "SBNN" read as a little endian number
+constexpr uint32_t MAGIC = 0x4E4E4253;
+
+// Activations are clipped to [0, QA], such that they fit 8 bits
+// The output is scaled from units of QA * QB to centipawns by SCALE
+constexpr int QA    = 127;
+constexpr int QB    = 64;
+constexpr int SCALE = 400;
+// Outputs are bounded well below known wins, such that no evaluation is taken for a mate or a
+// tablebase score, and kept within the 16 bits of the evaluation stored in the TT
+constexpr int MAX_OUTPUT = Values::KNOWN_WIN / 2;
+
+struct alignas(64) Network {
+    std::array<std::array<int16_t, HIDDEN_SIZE>, INPUT_SIZE> inputWeights;
+    std::array<int16_t, HIDDEN_SIZE> inputBias;
+    // The weights of the side to move, followed by those of the other side
+    std::array<int8_t, COLOR_COUNT * HIDDEN_SIZE> outputWeights;
+    int32_t outputBias;
+};
+
+std::unique_ptr<Network> network;
+uint64_t id    = 0;
+size_t version = 0;
+
+void Set(std::unique_ptr<Network> net) {
+    network = std::move(net);
+    id      = ++version * 0x9E3779B97F4A7C15ull;
+}
+
+// Returns the input of a piece as seen from a perspective, for which the board is mirrored if black
+size_t Feature(Color perspective, Color color, Piece piece, Square square) {
+    const size_t relative = static_cast<size_t>(square) ^ ((perspective == WHITE) ? 0 : 56);
+    const size_t index    = (color != perspective) * PIECE_COUNT + static_cast<size_t>(piece);
+    return index * SQUARE_COUNT + relative;
+}
+
+template <typename T>
+bool Read(std::ifstream &file, T &value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+template <typename T>
+bool Write(std::ofstream &file, const T &value) {
+    return static_cast<bool>(file.write(reinterpret_cast<const char *>(&value), sizeof(T)));
+}
+
+#if defined(__AVX2__)
+int Propagate(const Accumulator &accumulator, Color turn) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa   = _mm256_set1_epi16(QA);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum        = _mm256_setzero_si256();
+    for (size_t side = 0; side < COLOR_COUNT; side++) {
+        const int16_t *values = accumulator.values[side == 0 ? turn : ~turn].data();
+        const int8_t *weights = network->outputWeights.data() + side * HIDDEN_SIZE;
+        for (size_t i = 0; i < HIDDEN_SIZE; i += 32) {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(values + i));
+            __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(values + i + 16));
+            a         = _mm256_min_epi16(_mm256_max_epi16(a, zero), qa);
+            b         = _mm256_min_epi16(_mm256_max_epi16(b, zero), qa);
+            // Packing interleaves the 128 bit lanes of both halves, which the permute undoes
+            const __m256i x = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0b11011000);
+            const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+            // Pairs of products fit 16 bits, as activations are at most 127
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+        }
+    }
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    total         = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0x4E));
+    total         = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0xB1));
+    return _mm_cvtsi128_si32(total);
+}
+#elif defined(__SSSE3__)
+int Propagate(const Accumulator &accumulator, Color turn) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i qa   = _mm_set1_epi16(QA);
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum        = _mm_setzero_si128();
+    for (size_t side = 0; side < COLOR_COUNT; side++) {
+        const int16_t *values = accumulator.values[side == 0 ? turn : ~turn].data();
+        const int8_t *weights = network->outputWeights.data() + side * HIDDEN_SIZE;
+        for (size_t i = 0; i < HIDDEN_SIZE; i += 16) {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(values + i));
+            __m128i b = _mm_load_si128(reinterpret_cast<const __m128i *>(values + i + 8));
+            a         = _mm_min_epi16(_mm_max_epi16(a, zero), qa);
+            b         = _mm_min_epi16(_mm_max_epi16(b, zero), qa);
+            const __m128i x = _mm_packus_epi16(a, b);
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+            sum             = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, w), ones));
+        }
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+int PropagateScalar(const Accumulator &accumulator, Color turn) {
+    int sum = 0;
+    for (size_t side = 0; side < COLOR_COUNT; side++) {
+        const auto &values    = accumulator.values[side == 0 ? turn : ~turn];
+        const int8_t *weights = network->outputWeights.data() + side * HIDDEN_SIZE;
+        for (size_t i = 0; i < HIDDEN_SIZE; i++)
+            sum += std::clamp<int>(values[i], 0, QA) * weights[i];
+    }
+    return sum;
+}
+
+int Output(int sum) {
+    const int64_t output = (static_cast<int64_t>(sum) + network->outputBias) * SCALE / (QA * QB);
+    return std::clamp<int64_t>(output, -MAX_OUTPUT, MAX_OUTPUT);
+}
+} // namespace
+
+bool Load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    uint32_t magic, hiddenSize;
+    if (!Read(file, magic) || magic != MAGIC) return false;
+    if (!Read(file, hiddenSize) || hiddenSize != HIDDEN_SIZE) return false;
+
+    auto net = std::make_unique<Network>();
+    if (!Read(file, net->inputBias) || !Read(file, net->inputWeights) ||
+        !Read(file, net->outputWeights) || !Read(file, net->outputBias))
+        return false;
+    Set(std::move(net));
+    return true;
+}
+
+bool Save(const std::string &path) {
+    if (!network) return false;
+    std::ofstream file(path, std::ios::binary);
+    return Write(file, MAGIC) && Write(file, static_cast<uint32_t>(HIDDEN_SIZE)) &&
+           Write(file, network->inputBias) && Write(file, network->inputWeights) &&
+           Write(file, network->outputWeights) && Write(file, network->outputBias);
+}
+
+void Disable() {
+    network.reset();
+    id = 0;
+}
+
+bool Enabled() { return network != nullptr; }
+
+uint64_t Id() { return id; }
+
+void Refresh(Accumulator &accumulator, const Position &position) {
+    accumulator.values.fill(network->inputBias);
+    for (const Color color : {WHITE, BLACK})
+        for (const Piece piece : PIECES)
+            for (BB pieces = position.pieces[piece] & position.colors[color]; pieces;)
+                Add(accumulator, color, piece, lsb_pop(pieces));
+    accumulator.hash     = position.hash;
+    accumulator.computed = true;
+}
+
+void Add(Accumulator &accumulator, Color color, Piece piece, Square square) {
+    for (const Color perspective : {WHITE, BLACK}) {
+        const auto &weights = network->inputWeights[Feature(perspective, color, piece, square)];
+        auto &values        = accumulator.values[perspective];
+        for (size_t i = 0; i < HIDDEN_SIZE; i++)
+            values[i] += weights[i];
+    }
+}
+
+void Sub(Accumulator &accumulator, Color color, Piece piece, Square square) {
+    for (const Color perspective : {WHITE, BLACK}) {
+        const auto &weights = network->inputWeights[Feature(perspective, color, piece, square)];
+        auto &values        = accumulator.values[perspective];
+        for (size_t i = 0; i < HIDDEN_SIZE; i++)
+            values[i] -= weights[i];
+    }
+}
+
+int Evaluate(const Accumulator &accumulator, Color turn) {
+#if defined(__AVX2__) || defined(__SSSE3__)
+    return Output(Propagate(accumulator, turn));
+#else
+    return Output(PropagateScalar(accumulator, turn));
+#endif
+}
+
+namespace Internal {
+void Randomize(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    const auto random = [&rng](int min, int max) {
+        return std::uniform_int_distribution<int>(min, max)(rng);
+    };
+
+    auto net = std::make_unique<Network>();
+    for (auto &weights : net->inputWeights)
+        for (auto &weight : weights)
+            weight = random(-32, 32);
+    for (auto &bias : net->inputBias)
+        bias = random(-64, 64);
+    // Small output weights keep evaluations to hundreds of centipawns, within the bounds of outputs
+    for (auto &weight : net->outputWeights)
+        weight = random(-16, 16);
+    net->outputBias = random(-QA * QB, QA * QB);
+    Set(std::move(net));
+}
+
+int EvaluateScalar(const Accumulator &accumulator, Color turn) {
+    return Output(PropagateScalar(accumulator, turn));
+}
+} // namespace Internal
+} // namespace NNUE
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "position.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+
+// An efficiently updatable neural network, evaluating in place of the hand crafted evaluation
+// once loaded
+//
+// Each perspective has its own hidden layer, whose inputs are the 768 combinations of piece, color
+// relative to the perspective, and square, mirrored for black. As a move only changes a few of
+// them, the hidden layers are updated by adding and subtracting the weights of those inputs.
+namespace NNUE {
+constexpr size_t INPUT_SIZE  = 2 * PIECE_COUNT * SQUARE_COUNT;
+constexpr size_t HIDDEN_SIZE = 256;
+
+// The hidden layers of both perspectives for a single position
+struct alignas(64) Accumulator {
+    std::array<std::array<int16_t, HIDDEN_SIZE>, COLOR_COUNT> values;
+    // The hash of the position the values belong to, if computed
+    uint64_t hash = 0;
+    bool computed = false;
+};
+
+// Loads the network from a file, returning whether it succeeded
+// On failure, the prior network, if any, is kept
+bool Load(const std::string &path);
+// Writes the network to a file, returning whether it succeeded
+bool Save(const std::string &path);
+// Unloads the network, returning to the hand crafted evaluation
+void Disable();
+// Returns whether a network is loaded
+bool Enabled();
+// Returns a number identifying the loaded network, or zero if none is
+uint64_t Id();
+
+// Computes the hidden layers of a position from scratch
+void Refresh(Accumulator &accumulator, const Position &position);
+// Adds or removes a piece from the hidden layers
+void Add(Accumulator &accumulator, Color color, Piece piece, Square square);
+void Sub(Accumulator &accumulator, Color color, Piece piece, Square square);
+// Returns the evaluation of the hidden layers, relative to the side to move
+int Evaluate(const Accumulator &accumulator, Color turn);
+
+namespace Internal {
+// Replaces the network with one of random weights, for testing
+void Randomize(uint64_t seed);
+// Same as Evaluate, though without SIMD, as a reference for it
+int EvaluateScalar(const Accumulator &accumulator, Color turn);
+} // namespace Internal
+} // namespace NNUE
@@ -0,0 +1,106 @@
+#include "packed.hpp"
+#include "bit.hpp"
+#include "position.hpp"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Packed {
+Record Pack(const Board &board, int score, int result) {
+    assert(popcount(board.Pieces()) <= 32);
+    Record record{};
+    record.occupancy = board.Pieces();
+    size_t i         = 0;
+    for (BB pieces = record.occupancy; pieces; i++) {
+        const Square square = lsb_pop(pieces);
+        const size_t code   = board.SquarePiece(square) | (board.SquareColor(square) << 3);
+        record.pieces[i / 2] |= code << (4 * (i % 2));
+    }
+
+    const auto castling = [&board](Color color) {
+        return static_cast<uint8_t>(board.GetCastling(color));
+    };
+    record.flags    = board.Turn() | (castling(WHITE) << 1) | (castling(BLACK) << 3);
+    record.ep       = board.EP();
+    record.halfmove = std::min<size_t>(board.HalfMoveClock(), UINT8_MAX);
+    record.result   = result;
+    record.score    = (score == NO_SCORE) ? NO_SCORE : std::clamp(score, -INT16_MAX, INT16_MAX);
+    record.fullMove = std::min<size_t>(board.FullMoveNumber(), UINT16_MAX);
+    return record;
+}
+
+Board Unpack(const Record &record) {
+    Position position;
+    size_t i = 0;
+    for (BB occupancy = record.occupancy; occupancy; i++) {
+        const size_t code = (record.pieces[i / 2] >> (4 * (i % 2))) & 0xF;
+        PlacePiece(
+            position, static_cast<Color>(code >> 3), static_cast<Piece>(code & 7),
+            lsb_pop(occupancy)
+        );
+    }
+    const std::array<Castling, COLOR_COUNT> castling = {
+        static_cast<Castling>((record.flags >> 1) & 3),
+        static_cast<Castling>((record.flags >> 3) & 3),
+    };
+    SetState(
+        position, static_cast<Color>(record.flags & 1), castling, static_cast<Square>(record.ep)
+    );
+    position.halfmove = record.halfmove;
+    return Board(position, record.fullMove);
+}
+
+Writer::Writer(const std::string &path, bool append)
+    : _file(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc)) {}
+
+bool Writer::IsOpen() const { return _file.is_open(); }
+
+void Writer::Write(const Record &record) { Write(std::span(&record, 1)); }
+
+void Writer::Write(std::span<const Record> records) {
+    _file.write(reinterpret_cast<const char *>(records.data()), records.size_bytes());
+}
+
+void Writer::Flush() { _file.flush(); }
+
+Reader::Reader(const std::string &path) : _file(path, std::ios::binary), _buffer(BUFFER_SIZE) {}
+
+bool Reader::IsOpen() const { return _file.is_open(); }
+
+bool Reader::Next(Record &record) {
+    if (_next == _count) {
+        _file.read(reinterpret_cast<char *>(_buffer.data()), BUFFER_SIZE * sizeof(Record));
+        _count = _file.gcount() / sizeof(Record);
+        _next  = 0;
+        if (_count == 0) return false;
+    }
+    record = _buffer[_next++];
+    return true;
+}
+
+Mapping::Mapping(const std::string &path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(Record))) {
+        void *address = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (address != MAP_FAILED) {
+            _address = address;
+            _length  = status.st_size;
+        }
+    }
+    close(fd);
+}
+
+Mapping::~Mapping() {
+    if (_address != nullptr) munmap(_address, _length);
+}
+
+bool Mapping::IsOpen() const { return _address != nullptr; }
+
+std::span<const Record> Mapping::Records() const {
+    return std::span(static_cast<const Record *>(_address), _length / sizeof(Record));
+}
+} // namespace Packed
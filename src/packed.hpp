@@ -0,0 +1,94 @@
+#pragma once
+
+#include "board.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+// Positions packed into records of 32 bytes, for datasets which are read far more often than
+// written, such as those of tuning
+namespace Packed {
+// Marks a record without a score or without a result
+constexpr int16_t NO_SCORE = INT16_MIN;
+constexpr int8_t NO_RESULT = INT8_MIN;
+
+// The pieces are listed by the order of the occupied squares, from A1 to H8, two to a byte with
+// the first in the lower bits, each as its piece with the color in the highest bit
+struct Record {
+    BB occupancy;
+    std::array<uint8_t, 16> pieces;
+    // The side to move in the lowest bit, followed by the castling rights of white and black
+    uint8_t flags;
+    uint8_t ep;
+    uint8_t halfmove;
+    // The result for white, of 1 for a win, 0 for a draw and -1 for a loss
+    int8_t result;
+    // The score relative to the side to move
+    int16_t score;
+    uint16_t fullMove;
+};
+
+static_assert(sizeof(Record) == 32);
+// Records are read in place from files, which are little endian
+static_assert(std::endian::native == std::endian::little);
+
+// Packs the position of the board, whose score is clamped to that of the record
+Record Pack(const Board &board, int score = NO_SCORE, int result = NO_RESULT);
+// Unpacks a record, which must be valid, as those given by Pack
+Board Unpack(const Record &record);
+
+// Writes records to a file, either replacing or appending to it
+class Writer {
+public:
+    Writer(const std::string &path, bool append = false);
+
+    bool IsOpen() const;
+    void Write(const Record &record);
+    void Write(std::span<const Record> records);
+    // Writes the records written so far to the file
+    void Flush();
+
+private:
+    std::ofstream _file;
+};
+
+// Reads the records of a file one by one, holding no more than a buffer of them
+// A partial record at the end, as of a file being written, is not read
+class Reader {
+public:
+    Reader(const std::string &path);
+
+    bool IsOpen() const;
+    // Reads the next record, returning false once there are none left
+    bool Next(Record &record);
+
+private:
+    static constexpr size_t BUFFER_SIZE = 4096;
+
+    std::ifstream _file;
+    std::vector<Record> _buffer;
+    size_t _next  = 0;
+    size_t _count = 0;
+};
+
+// Maps the records of a file, which are read in place
+// A partial record at the end, as of a file being written, is left out
+class Mapping {
+public:
+    Mapping(const std::string &path);
+    ~Mapping();
+    Mapping(const Mapping &)            = delete;
+    Mapping &operator=(const Mapping &) = delete;
+
+    bool IsOpen() const;
+    std::span<const Record> Records() const;
+
+private:
+    void *_address = nullptr;
+    size_t _length = 0;
+};
+} // namespace Packed
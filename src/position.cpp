@@ -0,0 +1,27 @@
+#include "position.hpp"
+#include "values.hpp"
+#include "zobrist.hpp"
+
+void PlacePiece(Position &position, Color color, Piece piece, Square square) {
+    position.colors[color] ^= square;
+    position.pieces[piece] ^= square;
+    Zobrist::FlipSquare(position.hash, square, piece, color);
+    if (piece == PAWN) Zobrist::FlipSquare(position.pawn_hash, square, piece, color);
+    Zobrist::AddMaterial(position.material_hash, piece, color);
+    const int sign = (color == WHITE) ? 1 : -1;
+    position.psq += Values::PSQ[color][piece][square] * sign;
+    position.phase += Values::PHASE_INC[piece];
+    position.squares[square] = piece;
+}
+
+void SetState(
+    Position &position, Color turn, std::array<Castling, COLOR_COUNT> castling, Square ep
+) {
+    position.turn     = turn;
+    position.castling = castling;
+    position.ep       = ep;
+    if (turn == BLACK) Zobrist::FlipColor(position.hash);
+    Zobrist::FlipCastling(position.hash, WHITE, castling[WHITE]);
+    Zobrist::FlipCastling(position.hash, BLACK, castling[BLACK]);
+    Zobrist::FlipEnPassant(position.hash, ep);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "score.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstdint>
+
+// The state of a single position, without any history
+// Kept compact such that copying it, for instance to another thread, is cheap
+struct alignas(64) Position {
+    std::array<BB, PIECE_COUNT> pieces{};
+    std::array<BB, COLOR_COUNT> colors{};
+    uint64_t hash = 0;
+    // Hashes of the pawns only, and of the count of each piece, for keying evaluation caches
+    uint64_t pawn_hash     = 0;
+    uint64_t material_hash = 0;
+    // The piece on each square, or PIECE_NONE
+    std::array<uint8_t, SQUARE_COUNT> squares = [] {
+        std::array<uint8_t, SQUARE_COUNT> squares;
+        squares.fill(PIECE_NONE);
+        return squares;
+    }();
+    uint8_t turn = WHITE;
+    uint8_t ep   = SQUARE_NONE;
+    std::array<Castling, COLOR_COUNT> castling{Castling::None, Castling::None};
+    // Plies since the last capture or pawn move
+    uint16_t halfmove = 0;
+    // Sum of the piece square values, white's minus black's, and the game phase of the pieces
+    Score psq;
+    int32_t phase = 0;
+};
+
+static_assert(sizeof(Position) <= 192);
+
+// Adds a piece to an empty square of the position, updating its hashes and values
+// Unlike Board::PlacePiece, there are no hidden layers of the network to update
+void PlacePiece(Position &position, Color color, Piece piece, Square square);
+// Sets the side to move, castling rights and en passant square of a position which has none of
+// them set, updating its hash
+void SetState(
+    Position &position, Color turn, std::array<Castling, COLOR_COUNT> castling, Square ep
+);
@@ -0,0 +1,61 @@
+#include "position_command.hpp"
+#include <algorithm>
+
+namespace PositionCommand {
+namespace {
+constexpr std::string_view WHITESPACE = " \t\r\n";
+} // namespace
+
+std::string_view NextToken(std::string_view &view) {
+    const size_t start           = std::min(view.find_first_not_of(WHITESPACE), view.size());
+    const size_t end             = std::min(view.find_first_of(WHITESPACE, start), view.size());
+    const std::string_view token = view.substr(start, end - start);
+    view.remove_prefix(end);
+    return token;
+}
+
+FEN::Error Apply(Board &board, std::string_view args, Last &last) {
+    std::string_view fen;
+    std::string_view token = NextToken(args);
+    if (token == "startpos") {
+        fen = FEN_START;
+        NextToken(args);
+    } else if (token == "fen") {
+        // The fields of the FEN run up to the moves, and are parsed where they are
+        const char *begin = nullptr;
+        const char *end   = nullptr;
+        while (!(token = NextToken(args)).empty() && token != "moves") {
+            if (begin == nullptr) begin = token.data();
+            end = token.data() + token.size();
+        }
+        fen = std::string_view(begin, end - begin);
+    }
+    Position position;
+    const FEN::Result result = FEN::Parse(fen, position);
+    if (result.error != FEN::Error::None) return result.error;
+
+    // Skip the moves which were already applied, if the command extends the last one
+    std::string_view moves = args;
+    bool extends           = (fen == last.fen);
+    for (size_t p = 0; extends && p < last.moves.size(); p += token.size() + 1) {
+        token            = NextToken(moves);
+        const size_t end = p + token.size();
+        extends          = !token.empty() && last.moves.compare(p, token.size(), token) == 0 &&
+                  (end == last.moves.size() || last.moves[end] == ' ');
+    }
+    if (extends)
+        args = moves;
+    else {
+        board    = Board(position, result.fullMove);
+        last.fen = fen;
+        last.moves.clear();
+    }
+
+    while (!(token = NextToken(args)).empty()) {
+        board.ApplyMove(Move(board.Pieces(), board.Pieces(KING), board.Pieces(PAWN), token));
+        if (!last.moves.empty()) last.moves += ' ';
+        last.moves += token;
+    }
+    return FEN::Error::None;
+}
+} // namespace PositionCommand
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "board.hpp"
+#include "fen.hpp"
+#include <string>
+#include <string_view>
+
+// The position command of UCI, which GUIs resend with the whole game before each search, such that
+// only moves beyond those of the last command are applied
+namespace PositionCommand {
+// The position command last applied to a board
+struct Last {
+    std::string fen;
+    std::string moves;
+};
+
+// Removes and returns the next whitespace separated token of the view
+std::string_view NextToken(std::string_view &view);
+// Applies the arguments of a position command to the board, which the last command was applied to
+// An invalid position is ignored, keeping the prior one, and its error returned
+FEN::Error Apply(Board &board, std::string_view args, Last &last);
+} // namespace PositionCommand
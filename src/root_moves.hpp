@@ -0,0 +1,83 @@
+#pragma once
+
+#include "board.hpp"
+#include "move.hpp"
+#include "move_gen.hpp"
+#include "pv.hpp"
+#include "values.hpp"
+#include <algorithm>
+#include <vector>
+
+// A legal move from the root position, along with its score from the latest iteration
+struct RootMove {
+    Move move;
+    int score         = -Values::INF;
+    int previousScore = -Values::INF;
+    // Nodes searched beneath the move during the current search
+    size_t nodes = 0;
+    PV pv;
+};
+
+// The legal moves of the root position, kept across the iterations of a search
+struct RootMoves {
+public:
+    RootMoves(Board &board) {
+        for (const Move move : GenerateMovesAll(board, board.Turn())) {
+            board.ApplyMove(move);
+            if (board.IsKingSafe(~board.Turn())) _moves.push_back(RootMove{.move = move});
+            board.UndoMove(move);
+        }
+    }
+
+    inline bool empty() const { return _moves.empty(); }
+    inline size_t size() const { return _moves.size(); }
+
+    inline RootMove &operator[](size_t i) { return _moves[i]; }
+    inline const RootMove &operator[](size_t i) const { return _moves[i]; }
+    inline std::vector<RootMove>::iterator begin() { return _moves.begin(); }
+    inline std::vector<RootMove>::iterator end() { return _moves.end(); }
+    inline std::vector<RootMove>::const_iterator begin() const { return _moves.begin(); }
+    inline std::vector<RootMove>::const_iterator end() const { return _moves.end(); }
+
+    // Total nodes searched beneath all root moves
+    inline size_t nodes() const {
+        size_t total = 0;
+        for (const RootMove &rm : _moves)
+            total += rm.nodes;
+        return total;
+    }
+
+    // Fraction of nodes spent beneath the best move, a measure of how settled the search is
+    inline double best_share() const {
+        const size_t total = nodes();
+        return (total == 0) ? 0.0 : static_cast<double>(_moves[0].nodes) / total;
+    }
+
+    // Removes the moves for which the predicate holds
+    template <typename F>
+    inline void remove_if(F predicate) {
+        std::erase_if(_moves, predicate);
+    }
+
+    // Stores the scores of the finished iteration, and orders moves by them
+    // Moves with equal scores are ordered by the size of their subtree
+    inline void next_iteration() {
+        for (RootMove &rm : _moves)
+            rm.previousScore = rm.score;
+        std::stable_sort(_moves.begin(), _moves.end(), [](const RootMove &l, const RootMove &r) {
+            if (l.previousScore != r.previousScore) return l.previousScore > r.previousScore;
+            return l.nodes > r.nodes;
+        });
+    }
+
+    // Stably orders moves in the range [first, last) by score
+    inline void sort(size_t first, size_t last) {
+        std::stable_sort(
+            _moves.begin() + first, _moves.begin() + last,
+            [](const RootMove &l, const RootMove &r) { return l.score > r.score; }
+        );
+    }
+
+private:
+    std::vector<RootMove> _moves;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// A pair of middle and end game values, packed into a single integer
+// The end game value is the lower half, and the middle game value the upper, such that both
+// are added or subtracted by a single instruction
+// Each value must stay within the range of 16 bit integers
+// The packed value is unsigned, such that pairs at the ends of the ranges wrap rather than overflow
+struct Score {
+public:
+    constexpr Score() : _value(0) {}
+    constexpr Score(int mg, int eg)
+        : _value((static_cast<uint32_t>(mg) << 16) + static_cast<uint32_t>(eg)) {}
+
+    // The end game value borrows from the upper half when negative, which is rounded away
+    constexpr int MG() const {
+        return static_cast<int16_t>((_value + 0x8000) >> 16);
+    }
+    constexpr int EG() const { return static_cast<int16_t>(static_cast<uint16_t>(_value)); }
+    // Interpolates between the middle and end game values, by a phase from 0 (end game) to 24
+    constexpr int Taper(int phase) const { return (MG() * phase + EG() * (24 - phase)) / 24; }
+
+    constexpr Score operator+(Score other) const { return FromValue(_value + other._value); }
+    constexpr Score operator-(Score other) const { return FromValue(_value - other._value); }
+    constexpr Score operator-() const { return FromValue(0 - _value); }
+    constexpr Score operator*(int factor) const {
+        return FromValue(_value * static_cast<uint32_t>(factor));
+    }
+    constexpr Score &operator+=(Score other) { return *this = *this + other; }
+    constexpr Score &operator-=(Score other) { return *this = *this - other; }
+    constexpr bool operator==(const Score &other) const = default;
+
+private:
+    uint32_t _value;
+
+    static constexpr Score FromValue(uint32_t value) {
+        Score score;
+        score._value = value;
+        return score;
+    }
+};
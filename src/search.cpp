@@ -1,21 +1,30 @@
 #include "search.hpp"
+#include "bit.hpp"
+#include "evaluation.hpp"
 #include "move_gen.hpp"
 #include "pv.hpp"
+#include "tablebase.hpp"
 #include "tt.hpp"
 #include "types.hpp"
 #include "values.hpp"
-#include <csetjmp>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace Search {
 namespace {
-PV ExtractPV(Board board) {
+// Centipawns reported for a tablebase win at the root, above any evaluation though far from the
+// values GUIs read as mates
+constexpr int UCI_TB_WIN = 20000;
+
+PV ExtractPV(Board board, Move rootMove) {
     const size_t ply = board.Ply();
-    std::vector<Move> moves;
+    std::vector<Move> moves{rootMove};
+    board.ApplyMove(rootMove);
     while (moves.size() < 8) {
         const Move move = TT::ProbeMove(board.GetHash());
         if (move.IsDefined()) {
@@ -28,67 +37,162 @@ PV ExtractPV(Board board) {
     return PV(ply, moves);
 }
 
-Move IterativeDeepening(Board &board, int timeLimit) {
-    std::jmp_buf exitBuffer;
-    SearchLimit limit = SearchLimit(exitBuffer, timeLimit);
+// Keeps only the root moves which preserve the result of a position within the tablebases
+// Returns whether the position is within them
+bool FilterTablebase(Board &board, RootMoves &rootMoves) {
+    const Tablebase::WDL wdl = Tablebase::Probe(board);
+    if (wdl == Tablebase::WDL::None) return false;
+    rootMoves.remove_if([&](const RootMove &rm) {
+        board.ApplyMove(rm.move);
+        const Tablebase::WDL after = Tablebase::Probe(board);
+        board.UndoMove(rm.move);
+        // Those which cannot be probed, as after a double pawn push, are kept
+        return after != Tablebase::WDL::None && static_cast<int>(after) != -static_cast<int>(wdl);
+    });
+    return true;
+}
+
+// Writes the lines of a finished iteration as UCI info
+void Report(const RootMoves &rootMoves, size_t multiPV, size_t depth, size_t t, size_t nodes) {
+    const size_t hashfull = TT::HashFull();
+    for (size_t pvIdx = 0; pvIdx < multiPV; pvIdx++) {
+        const RootMove &rm = rootMoves[pvIdx];
+        // Each line is written at once, as another thread may write to the output as well
+        char buffer[160];
+        snprintf(
+            buffer, sizeof(buffer),
+            "info depth %zu multipv %zu score %s time %zu ms nodes %zu nps %zu hashfull %zu pv",
+            depth, pvIdx + 1, Internal::UciScore(rm.score).c_str(), t, nodes,
+            nodes * 1000 / std::max(t, (size_t)1), hashfull
+        );
+        std::string line = buffer;
+        for (size_t i = 0; i < rm.pv.size(); i++)
+            line += " " + rm.pv[i].Export();
+        std::cout << line + '\n' << std::flush;
+    }
+    const Evaluation::CacheStats stats = Evaluation::GetCacheStats();
+    char buffer[80];
+    snprintf(
+        buffer, sizeof(buffer), "info string evalcache hits %zu%% pawntable hits %zu%%\n",
+        stats.evalHits * 100 / std::max(stats.evalProbes, (size_t)1),
+        stats.pawnHits * 100 / std::max(stats.pawnProbes, (size_t)1)
+    );
+    std::cout << buffer << std::flush;
+}
+
+// Returns the best root move of each line of the last finished iteration, along with the line
+// The iterations are written as UCI info, unless quiet
+std::vector<RootMove> IterativeDeepening(
+    Board &board, RootMoves &rootMoves, const Limits &limits, SearchLimit &limit,
+    TimeManager &timeManager, size_t multiPV, bool quiet
+) {
+    const size_t maxDepth = limits.depth ? std::min(limits.depth + 1, MAX_PLY) : MAX_PLY;
+
+    multiPV = std::min(multiPV, rootMoves.size());
 
-    PV pv                       = PV();
-    int alpha                   = -Values::INF;
-    int beta                    = Values::INF;
+    // Best moves of the last finished iteration
+    std::vector<RootMove> best  = {rootMoves[0]};
+    best[0].pv                  = PV(board.Ply(), {best[0].move});
     const size_t priorMoveCount = board.MoveCount();
-    for (size_t depth = 1; depth < MAX_PLY && !setjmp(exitBuffer); depth++) {
-        auto t0   = std::chrono::steady_clock::now();
-        int score = Internal::Negamax(board, alpha, beta, depth, 0, pv, &limit);
-        if ((score <= alpha) || (score >= beta)) {
-            alpha = -Values::INF;
-            beta  = Values::INF;
-            score = Internal::Negamax(board, alpha, beta, depth, 0, pv, &limit);
-        } else {
-            alpha = score - 50;
-            beta  = score + 50;
+    Evaluation::ResetCacheStats();
+    for (size_t depth = 1; depth < maxDepth; depth++) {
+        auto t0 = std::chrono::steady_clock::now();
+        rootMoves.next_iteration();
+        for (size_t pvIdx = 0; pvIdx < multiPV && !limit.Stopped(); pvIdx++) {
+            const int previous = rootMoves[pvIdx].previousScore;
+            int alpha          = (depth > 1) ? previous - 50 : -Values::INF;
+            int beta           = (depth > 1) ? previous + 50 : Values::INF;
+            int score = Internal::Root(board, rootMoves, pvIdx, alpha, beta, depth, &limit);
+            if (!limit.Stopped() && ((score <= alpha) || (score >= beta))) {
+                alpha = -Values::INF;
+                beta  = Values::INF;
+                Internal::Root(board, rootMoves, pvIdx, alpha, beta, depth, &limit);
+            }
+            if (limit.Stopped()) break;
+            // Moves which did not improve alpha keep their order from the prior iteration
+            rootMoves.sort(pvIdx, rootMoves.size());
+            // A later line may have been underestimated by a reduced search of an earlier one
+            rootMoves.sort(0, pvIdx + 1);
         }
+        if (limit.Stopped()) break;
+
         auto t1  = std::chrono::steady_clock::now();
         size_t t = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
-        timeLimit -= t;
-        pv                 = ExtractPV(board);
-        const size_t nodes = board.MoveCount() - priorMoveCount;
-        printf(
-            "info depth %zu score cp %d time %zu ms nodes %zu nps %zu hashfull %zu pv ", depth,
-            score, t, nodes, nodes * 1000 / std::max(t, (size_t)1), TT::HashFull()
-        );
-        for (size_t i = 0; i < pv.size(); i++)
-            std::cout << pv[i].Export() << " ";
-        std::cout << '\n';
-        std::flush(std::cout);
-        if (std::abs(score) == Values::INF) break;
+        for (size_t pvIdx = 0; pvIdx < multiPV; pvIdx++)
+            rootMoves[pvIdx].pv = ExtractPV(board, rootMoves[pvIdx].move);
+        if (!quiet) Report(rootMoves, multiPV, depth, t, board.MoveCount() - priorMoveCount);
+        best.assign(rootMoves.begin(), rootMoves.begin() + multiPV);
+        // Once a mate is found, the search stops rather than searching the tree again
+        if (Values::IsMate(rootMoves[0].score)) break;
+
+        timeManager.Update(t, rootMoves[0].move, rootMoves[0].score, rootMoves.best_share());
+        if (!limit.Pondering() && timeManager.ShouldStop(limit.Elapsed())) break;
     }
 
-    if (pv.empty()) {
-        // This should not happen, but nevertheless it sometimes does
-        printf("info pv empty, doing manual search at depth 3\n");
-        TT::Clear();
-        return GetBestMoveDepth(board, 3);
-    } else {
-        return pv[0];
+    return best;
+}
+
+// Searches the legal moves of the board, of which those losing a tablebase result are left out
+std::vector<RootMove> Run(
+    Board &board, const Limits &limits, SearchLimit &limit, size_t multiPV, bool quiet
+) {
+    TimeManager timeManager(limits, board.Turn());
+    const size_t maxMoveCount = limits.nodes ? board.MoveCount() + limits.nodes : SIZE_MAX;
+    // A limit started by an earlier phase, such as the mate solver, keeps its clock and moves
+    if (!limit.Started()) limit.Start(timeManager.Maximum(), maxMoveCount);
+
+    RootMoves rootMoves(board);
+    // Within the tablebases, positions of as many pieces as the root are searched rather than
+    // probed, such that the evaluation makes progress towards the known result
+    const bool tablebaseRoot = FilterTablebase(board, rootMoves);
+    Internal::SetTablebasePieces(
+        tablebaseRoot ? popcount(board.Pieces()) - 1 : Tablebase::MAX_PIECES
+    );
+    if (rootMoves.empty()) return {RootMove()};
+    // A single move is played at once, unless its score is wanted
+    if (rootMoves.size() == 1 && !quiet) {
+        rootMoves[0].pv = PV(board.Ply(), {rootMoves[0].move});
+        return {rootMoves[0]};
     }
+
+    return IterativeDeepening(board, rootMoves, limits, limit, timeManager, multiPV, quiet);
 }
 } // namespace
 
-Move GetBestMoveDepth(Board &board, int depth) {
-    std::optional<std::pair<Move, int>> bestMove;
-    for (auto move : GenerateMovesAll(board, board.Turn())) {
-        board.ApplyMove(move);
-        int value = -Internal::Negamax(board, -Values::INF, Values::INF, depth - 1, 0, PV());
-        board.UndoMove(move);
-        if (!bestMove.has_value() || value > bestMove.value().second) bestMove = {move, value};
+namespace Internal {
+std::string UciScore(int score) {
+    if (Values::IsMate(score)) {
+        const int moves =
+            (score > 0) ? (Values::MATE - score + 1) / 2 : -(Values::MATE + score) / 2;
+        return "mate " + std::to_string(moves);
     }
+    // Tablebase wins keep their preference for shorter wins, in place of their internal values
+    if (score >= Values::DISTANCE_BOUND) score = UCI_TB_WIN - (Values::TB_WIN - score);
+    if (score <= -Values::DISTANCE_BOUND) score = -UCI_TB_WIN + (Values::TB_WIN + score);
+    return "cp " + std::to_string(score);
+}
+} // namespace Internal
 
-    return bestMove.value().first;
+Move GetBestMoveDepth(Board &board, int depth) {
+    RootMoves rootMoves(board);
+    if (rootMoves.empty()) return Move();
+
+    Internal::Root(board, rootMoves, 0, -Values::INF, Values::INF, depth, nullptr);
+    rootMoves.sort(0, rootMoves.size());
+    return rootMoves[0].move;
 }
 
-Move GetBestMoveTime(Board &board, int timeLimit) {
-    if (auto moves = GenerateMovesAll(board, board.Turn()); moves.size() == 1) return moves[0];
+PV GetBestMove(Board &board, const Limits &limits, SearchLimit &limit, size_t multiPV) {
+    return Run(board, limits, limit, multiPV, false)[0].pv;
+}
+
+std::vector<RootMove> GetBestLines(
+    Board &board, const Limits &limits, SearchLimit &limit, size_t multiPV
+) {
+    return Run(board, limits, limit, multiPV, false);
+}
 
-    return IterativeDeepening(board, timeLimit);
+RootMove GetBestRootMove(Board &board, const Limits &limits, SearchLimit &limit) {
+    return Run(board, limits, limit, 1, true)[0];
 }
 } // namespace Search
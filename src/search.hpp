@@ -3,14 +3,18 @@
 #include "board.hpp"
 #include "move.hpp"
 #include "pv.hpp"
+#include "root_moves.hpp"
 #include "search_limit.hpp"
+#include "time_manager.hpp"
+#include <string>
+#include <vector>
 
 namespace Search {
 namespace Internal {
 /*
  * From a given position, searches all non-quiet moves
  */
-int Quiesce(Board &board, int alpha, int beta, const PV &pv);
+int Quiesce(Board &board, int alpha, int beta, int searchDepth, const PV &pv);
 /*
  * Finds optimal move for a given position, or until the limit is reached
  */
@@ -18,7 +22,35 @@ int Negamax(
     Board &board, int alpha, int beta, int depth, int searchDepth, const PV &pv,
     SearchLimit *limit = nullptr
 );
+/*
+ * Searches the root moves from index pvIdx onwards, excluding those before it
+ * The best move is given its score, all others are given -INF
+ */
+int Root(
+    Board &board, RootMoves &rootMoves, size_t pvIdx, int alpha, int beta, int depth,
+    SearchLimit *limit
+);
+/*
+ * Sets the most pieces of positions which are probed in the tablebases, rather than searched
+ */
+void SetTablebasePieces(size_t pieces);
+/*
+ * Writes the score as UCI does, in moves for mates, which are negative when mated
+ * Tablebase wins are written in centipawns, between any evaluation and the mates
+ */
+std::string UciScore(int score);
 }; // namespace Internal
 Move GetBestMoveDepth(Board &board, int depth);
-Move GetBestMoveTime(Board &board, int timeLimit);
+// Searches until the limits are met or the search is stopped
+// Returns the principal variation of the last finished iteration, whose first move is the best
+PV GetBestMove(Board &board, const Limits &limits, SearchLimit &limit, size_t multiPV = 1);
+// Searches as GetBestMove, though returning the lines of the last finished iteration, best first
+// There are as many lines as asked for, unless the root has fewer legal moves, or no iteration
+// finished, in which case there is only the first
+std::vector<RootMove> GetBestLines(
+    Board &board, const Limits &limits, SearchLimit &limit, size_t multiPV
+);
+// Searches as GetBestMove, though without writing any output
+// Returns the best root move of the last finished iteration, along with its score
+RootMove GetBestRootMove(Board &board, const Limits &limits, SearchLimit &limit);
 } // namespace Search
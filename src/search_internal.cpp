@@ -1,23 +1,52 @@
+#include "bit.hpp"
 #include "evaluation.hpp"
 #include "move_gen.hpp"
 #include "move_list.hpp"
 #include "move_ordering.hpp"
 #include "search.hpp"
+#include "tablebase.hpp"
 #include "tt.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace Search::Internal {
 namespace {
+// Kept for each thread, such that searches of several threads do not share them
+thread_local std::array<Move, MAX_PLY> killer_moves;
+// Positions of at most this many pieces are probed in the tablebases
+thread_local size_t tablebase_pieces = Tablebase::MAX_PIECES;
+
 bool AB(int score, int &alpha, int beta) {
     if (score >= beta) return true;
     if (score > alpha) alpha = score;
     return false;
 }
+
+// Returns whether any of the pseudo-legal moves is legal
+bool HasLegalMove(Board &board) {
+    for (const Move move : GenerateMovesAll(board, board.Turn())) {
+        board.ApplyMove(move);
+        const bool legal = board.IsKingSafe(~board.Turn());
+        board.UndoMove(move);
+        if (legal) return true;
+    }
+    return false;
+}
 } // namespace
-int Quiesce(Board &board, int alpha, int beta, const PV &pv) {
-    int standPat = Evaluation::Eval(board);
-    if (AB(standPat, alpha, beta)) return beta;
+int Quiesce(Board &board, int alpha, int beta, int searchDepth, const PV &pv) {
+    const uint64_t hash = board.GetHash();
+    auto tt             = TT::Probe(hash, 0, searchDepth, alpha, beta);
+    if (tt.score != TT::ProbeFail) return tt.score;
+
+    // The static evaluation of a stored position need not be computed again
+    const int staticEval = (tt.eval != TT::NoEval) ? tt.eval : Evaluation::Eval(board);
+    if (AB(staticEval, alpha, beta)) {
+        TT::StoreEval(hash, 0, searchDepth, beta, TT::ProbeLower, Move(), staticEval);
+        return beta;
+    }
 
+    int ttBound    = TT::ProbeUpper;
+    Move bm        = Move();
     MoveList moves = GenerateMovesTactical(board, board.Turn());
     MoveOrdering::MVVLVA(board, moves);
     MoveOrdering::PVPrioity(board, pv, moves);
@@ -27,28 +56,53 @@ int Quiesce(Board &board, int alpha, int beta, const PV &pv) {
             board.UndoMove(move);
             continue;
         }
-        int score = -Quiesce(board, -beta, -alpha, pv);
+        int score = -Quiesce(board, -beta, -alpha, searchDepth + 1, pv);
         board.UndoMove(move);
-        if (AB(score, alpha, beta)) return beta;
+        if (score >= beta) {
+            TT::StoreEval(hash, 0, searchDepth, beta, TT::ProbeLower, move, staticEval);
+            return beta;
+        }
+        if (score > alpha) {
+            alpha   = score;
+            ttBound = TT::ProbeExact;
+            bm      = move;
+        }
     }
 
+    TT::StoreEval(hash, 0, searchDepth, alpha, ttBound, bm, staticEval);
     return alpha;
 }
 
 int Negamax(
     Board &board, int alpha, int beta, int depth, int searchDepth, const PV &pv, SearchLimit *limit
 ) {
-    static std::array<Move, MAX_PLY> killer_moves;
-    if (searchDepth == 0) // New search
-        for (Move &move : killer_moves)
-            move = Move();
-
-    [[unlikely]] if (limit != nullptr && depth > 3 && limit->Reached())
-        limit->Exit();
-    [[unlikely]] if (board.IsThreefold())
+    [[unlikely]] if (limit != nullptr && limit->Reached(board.MoveCount()))
+        return 0;
+    // Within the search, a single repetition is enough, as either side could repeat it again
+    [[unlikely]] if (board.IsRepetition(searchDepth))
         return 0;
+    [[unlikely]] if (board.IsFiftyMoves()) {
+        // Checkmate takes precedence over the fifty move rule
+        if (board.IsKingSafe(board.Turn()) || HasLegalMove(board)) return 0;
+    }
+    // If a position of the search can be repeated, the side to move can at least draw
+    // Covers the entry to Quiesce as well, where only captures follow and none can be repeated
+    if (alpha < 0 && board.IsRepetitionUpcoming(searchDepth)) {
+        alpha = 0;
+        if (alpha >= beta) return beta;
+    }
+    // No mate can be shorter than one here, nor any loss longer than being mated next ply
+    alpha = std::max(alpha, Values::MatedIn(searchDepth));
+    beta  = std::min(beta, Values::MateIn(searchDepth + 1));
+    if (alpha >= beta) return alpha;
 
-    if (depth <= 0) return Quiesce(board, alpha, beta, pv);
+    if (static_cast<size_t>(popcount(board.Pieces())) <= tablebase_pieces) {
+        // Shorter wins are preferred, as well as longer losses
+        if (const Tablebase::WDL wdl = Tablebase::Probe(board); wdl != Tablebase::WDL::None)
+            return static_cast<int>(wdl) * (Values::TB_WIN - searchDepth);
+    }
+
+    if (depth <= 0) return Quiesce(board, alpha, beta, searchDepth, pv);
 
     const uint64_t hash = board.GetHash();
     auto tt             = TT::Probe(hash, depth, searchDepth, alpha, beta);
@@ -56,12 +110,13 @@ int Negamax(
 
     int ttBound    = TT::ProbeUpper;
     MoveList moves = GenerateMovesAll(board, board.Turn());
-    if (moves.empty()) return Evaluation::EvalNoMove(board);
+    if (moves.empty()) return Evaluation::EvalNoMove(board, searchDepth);
 
     if (Move killer_move = killer_moves[searchDepth]; killer_move.IsDefined())
         MoveOrdering::Killer(moves, killer_move);
     MoveOrdering::All(board, tt.move, pv, moves);
-    Move bm = moves[0];
+    Move bm           = moves[0];
+    size_t legalMoves = 0;
     for (size_t i = 0; i < moves.size(); i++) {
         const Move &move = moves[i];
         board.ApplyMove(move);
@@ -69,15 +124,20 @@ int Negamax(
             board.UndoMove(move);
             continue;
         }
+        legalMoves++;
         int score;
         if (i == 0)
             score = -Negamax(board, -beta, -alpha, depth - 1, searchDepth + 1, pv, limit);
         else {
             score = -Negamax(board, -alpha - 1, -alpha, depth - 2, searchDepth + 1, pv, limit);
-            if (score > alpha && score < beta)
+            // A reduced search beating alpha is verified at full depth, even when it fails high
+            if (score > alpha)
                 score = -Negamax(board, -beta, -alpha, depth - 1, searchDepth + 1, pv, limit);
         }
         board.UndoMove(move);
+        // The score of an unfinished search must not be stored
+        [[unlikely]] if (limit != nullptr && limit->Stopped())
+            return 0;
         if (score >= beta) {
             TT::StoreEval(hash, depth, searchDepth, beta, TT::ProbeLower, move);
             if (!move.IsCapture()) killer_moves[searchDepth] = move;
@@ -89,8 +149,51 @@ int Negamax(
             bm      = move;
         }
     }
+    // The generated moves are pseudo-legal, of which none may have been legal
+    if (legalMoves == 0) return Evaluation::EvalNoMove(board, searchDepth);
 
     TT::StoreEval(hash, depth, searchDepth, alpha, ttBound, bm);
     return alpha;
 }
+
+int Root(
+    Board &board, RootMoves &rootMoves, size_t pvIdx, int alpha, int beta, int depth,
+    SearchLimit *limit
+) {
+    for (Move &move : killer_moves)
+        move = Move();
+
+    for (size_t i = pvIdx; i < rootMoves.size(); i++) {
+        RootMove &rm            = rootMoves[i];
+        const size_t priorNodes = board.MoveCount();
+        board.ApplyMove(rm.move);
+        int score;
+        if (i == pvIdx)
+            score = -Negamax(board, -beta, -alpha, depth - 1, 1, rm.pv, limit);
+        else {
+            score = -Negamax(board, -alpha - 1, -alpha, depth - 2, 1, rm.pv, limit);
+            // Neither a cutoff nor a line of MultiPV may rest on a reduced search
+            if (score > alpha)
+                score = -Negamax(board, -beta, -alpha, depth - 1, 1, rm.pv, limit);
+        }
+        board.UndoMove(rm.move);
+        rm.nodes += board.MoveCount() - priorNodes;
+        [[unlikely]] if (limit != nullptr && limit->Stopped())
+            return alpha;
+        if (score >= beta) {
+            rm.score = beta;
+            return beta;
+        }
+        if (score > alpha) {
+            alpha    = score;
+            rm.score = score;
+        } else {
+            rm.score = -Values::INF;
+        }
+    }
+
+    return alpha;
+}
+
+void SetTablebasePieces(size_t pieces) { tablebase_pieces = pieces; }
 } // namespace Search::Internal
@@ -1,26 +1,155 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <csetjmp>
-#include <cstdlib>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 
 namespace Search {
+// Decides when a search stops
+// Apart from Start, Started and Reached, which belong to the searching thread, all members may be
+// used from another thread
 class SearchLimit {
 public:
-    SearchLimit(std::jmp_buf &jmpBuf, size_t searchTime);
-    bool Reached();
-    void Exit();
+    // A pondering search does not start its clock until PonderHit is called
+    SearchLimit(bool ponder = false);
+    // Limits the search to a time in ms, and optionally to a total move count of the board
+    // The clock starts now, unless pondering
+    void Start(size_t searchTime, size_t maxMoveCount = SIZE_MAX);
+    // Returns whether Start was called, such that a later phase of the search keeps its limits
+    bool Started() const;
+    // Returns whether the search should stop, given the current move count of the board
+    // The clock is only read once every CHECK_INTERVAL calls
+    bool Reached(size_t moveCount);
+    // Returns as Reached, or whether a phase of the search has used its share of the limits, the
+    // time in ms and the total move count of the board
+    // The end of a phase does not stop the search, whose later phases use the rest of the limits
+    bool Reached(size_t moveCount, size_t phaseTime, size_t phaseMoveCount);
+    // Returns whether the search has been stopped, without reading the clock
+    bool Stopped() const;
+    // Requests the search to stop
+    void Stop();
+    // Returns whether the search is pondering
+    bool Pondering() const;
+    // Starts the clock of a pondering search, as the expected move was played
+    void PonderHit();
+    // Blocks until stopped, or if not infinite, until no longer pondering
+    void Wait(bool infinite);
+    // Returns the time passed in ms since the clock started
+    size_t Elapsed() const;
+    // Returns the time passed since the stop was requested
+    std::chrono::microseconds StopLatency() const;
 
 private:
-    std::jmp_buf &_jmpBuf;
-    std::chrono::steady_clock::time_point _endTime;
+    static constexpr size_t CHECK_INTERVAL = 1024;
+    using Clock                            = std::chrono::steady_clock;
+
+    std::atomic<bool> _stopped = false;
+    std::atomic<bool> _pondering;
+    bool _started        = false;
+    size_t _polls        = 0;
+    size_t _maxMoveCount = SIZE_MAX;
+    std::atomic<size_t> _searchTime;
+    std::atomic<Clock::time_point> _startTime;
+    std::atomic<Clock::time_point> _endTime;
+    std::atomic<Clock::time_point> _stopTime;
+    std::mutex _mutex;
+    std::condition_variable _signal;
+
+    void Notify();
 };
 
-inline SearchLimit::SearchLimit(std::jmp_buf &jmpBuf, size_t searchTime)
-    : _jmpBuf(jmpBuf),
-      _endTime(std::chrono::steady_clock().now() + std::chrono::milliseconds(searchTime)) {}
+inline SearchLimit::SearchLimit(bool ponder)
+    : _pondering(ponder), _searchTime(SIZE_MAX), _startTime(Clock::now()),
+      _endTime(Clock::time_point::max()) {}
+
+inline void SearchLimit::Start(size_t searchTime, size_t maxMoveCount) {
+    _started      = true;
+    _maxMoveCount = maxMoveCount;
+    // Start and PonderHit each read what the other stores, such that without the lock, either
+    // could miss the other and leave the clock unstarted
+    std::lock_guard lock(_mutex);
+    _searchTime.store(searchTime, std::memory_order_relaxed);
+    if (!Pondering()) {
+        const Clock::time_point now = Clock::now();
+        _startTime.store(now, std::memory_order_relaxed);
+        if (searchTime != SIZE_MAX)
+            _endTime.store(now + std::chrono::milliseconds(searchTime), std::memory_order_relaxed);
+    }
+}
+
+inline bool SearchLimit::Reached(size_t moveCount) {
+    if (_stopped.load(std::memory_order_relaxed)) return true;
+    if (moveCount >= _maxMoveCount) [[unlikely]] {
+        Stop();
+        return true;
+    }
+    if (++_polls % CHECK_INTERVAL == 0) [[unlikely]] {
+        const Clock::time_point end = _endTime.load(std::memory_order_relaxed);
+        if (end < Clock::now()) {
+            _stopTime.store(end, std::memory_order_relaxed);
+            _stopped.store(true, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool SearchLimit::Reached(size_t moveCount, size_t phaseTime, size_t phaseMoveCount) {
+    if (Reached(moveCount)) return true;
+    if (moveCount >= phaseMoveCount) return true;
+    // The clock of a pondering search has not started, and is read as seldom as by Reached
+    return _polls % CHECK_INTERVAL == 0 && !Pondering() && Elapsed() >= phaseTime;
+}
+
+inline bool SearchLimit::Started() const { return _started; }
+
+inline bool SearchLimit::Stopped() const { return _stopped.load(std::memory_order_relaxed); }
+
+inline void SearchLimit::Stop() {
+    _stopTime.store(Clock::now(), std::memory_order_relaxed);
+    _stopped.store(true, std::memory_order_release);
+    Notify();
+}
+
+inline bool SearchLimit::Pondering() const { return _pondering.load(std::memory_order_acquire); }
+
+inline void SearchLimit::PonderHit() {
+    {
+        std::lock_guard lock(_mutex);
+        const Clock::time_point now = Clock::now();
+        const size_t searchTime     = _searchTime.load(std::memory_order_relaxed);
+        _startTime.store(now, std::memory_order_relaxed);
+        if (searchTime != SIZE_MAX)
+            _endTime.store(now + std::chrono::milliseconds(searchTime), std::memory_order_relaxed);
+        _pondering.store(false, std::memory_order_release);
+    }
+    _signal.notify_all();
+}
+
+inline void SearchLimit::Wait(bool infinite) {
+    std::unique_lock lock(_mutex);
+    _signal.wait(lock, [&] { return Stopped() || (!infinite && !Pondering()); });
+}
+
+inline size_t SearchLimit::Elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               Clock::now() - _startTime.load(std::memory_order_relaxed)
+    )
+        .count();
+}
 
-inline bool SearchLimit::Reached() { return _endTime < std::chrono::steady_clock::now(); }
+inline std::chrono::microseconds SearchLimit::StopLatency() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - _stopTime.load(std::memory_order_relaxed)
+    );
+}
 
-inline void SearchLimit::Exit() { longjmp(_jmpBuf, 1); }
+inline void SearchLimit::Notify() {
+    // Taking the lock orders the change before any waiter checks its condition
+    { std::lock_guard lock(_mutex); }
+    _signal.notify_all();
+}
 }; // namespace Search
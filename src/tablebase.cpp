@@ -0,0 +1,507 @@
+#include "tablebase.hpp"
+#include "bit.hpp"
+#include "bitboard.hpp"
+#include "move_gen.hpp"
+#include "move_list.hpp"
+#include "utilities.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace Tablebase {
+namespace {
+// Identifies the file format, "SBTB" read as a little endian number
+constexpr uint32_t MAGIC = 0x42544253;
+// The magic number followed by the number of positions
+constexpr size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+constexpr std::string_view EXTENSION = ".wdl";
+
+// Each position takes two bits of a file, while generation uses a byte with room for UNKNOWN
+enum Value : uint8_t { DRAW, WIN, LOSS, ILLEGAL, UNKNOWN };
+
+// The squares of the white king, the black king, then the white and black pieces in their order
+using Squares = std::array<Square, MAX_PIECES>;
+
+int Column(Square sq) { return static_cast<int>(Utilities::GetColumnIndex(sq)); }
+int Row(Square sq) { return static_cast<int>(Utilities::GetRowIndex(sq)); }
+
+// Mirrors a square by rows with 56, or by columns with 7
+Square Mirror(Square sq, int mask) { return static_cast<Square>(static_cast<int>(sq) ^ mask); }
+
+// The pieces of an ending, other than the kings, by side and by descending value
+struct Material {
+    std::array<std::vector<Piece>, COLOR_COUNT> pieces;
+
+    size_t count() const { return 2 + pieces[WHITE].size() + pieces[BLACK].size(); }
+    // Indexed by the side to move, the white king on the columns a to d, and the other pieces
+    size_t size() const { return COLOR_COUNT * 32 * (size_t(1) << (6 * (count() - 1))); }
+    Color color(size_t i) const {
+        return (i == 0 || (i >= 2 && i < 2 + pieces[WHITE].size())) ? WHITE : BLACK;
+    }
+    Piece piece(size_t i) const {
+        if (i < 2) return KING;
+        if (i < 2 + pieces[WHITE].size()) return pieces[WHITE][i - 2];
+        return pieces[BLACK][i - 2 - pieces[WHITE].size()];
+    }
+    // Identical pieces, of which there are at most two, are ordered by square
+    bool identical(size_t i) const {
+        return i >= 3 && color(i) == color(i - 1) && piece(i) == piece(i - 1);
+    }
+};
+
+// Parses the name of an ending, such as "KRPvKN"
+bool Parse(std::string_view name, Material &material) {
+    const size_t split = name.find('v');
+    if (split == std::string_view::npos || name.size() > MAX_PIECES + 1) return false;
+    const std::string_view sides[COLOR_COUNT] = {name.substr(0, split), name.substr(split + 1)};
+    for (const Color color : {WHITE, BLACK}) {
+        if (sides[color].empty() || sides[color][0] != 'K') return false;
+        material.pieces[color].clear();
+        for (const char c : sides[color].substr(1)) {
+            if (std::string_view("PNBRQ").find(c) == std::string_view::npos) return false;
+            material.pieces[color].push_back(ToPiece(c));
+        }
+        std::sort(material.pieces[color].begin(), material.pieces[color].end(), std::greater());
+    }
+    return material.count() >= 3;
+}
+
+uint64_t Key(const Material &material, bool swapped) {
+    uint64_t key = 0;
+    for (const Color side : {WHITE, BLACK}) {
+        const Color color = swapped ? ~side : side;
+        Zobrist::AddMaterial(key, KING, color);
+        for (const Piece piece : material.pieces[side])
+            Zobrist::AddMaterial(key, piece, color);
+    }
+    return key;
+}
+
+// Positions are mirrored by columns such that the white king is on the columns a to d, which
+// there is no castling or en passant to break the symmetry of
+size_t Index(const Material &material, Color turn, Squares squares) {
+    const size_t count = material.count();
+    if (Column(squares[0]) >= 4)
+        for (size_t i = 0; i < count; i++)
+            squares[i] = Mirror(squares[i], 7);
+    for (size_t i = 3; i < count; i++)
+        if (material.identical(i) && squares[i] < squares[i - 1])
+            std::swap(squares[i - 1], squares[i]);
+
+    size_t index = turn * 32 + Row(squares[0]) * 4 + Column(squares[0]);
+    for (size_t i = 1; i < count; i++)
+        index = index * SQUARE_COUNT + squares[i];
+    return index;
+}
+
+Color Decode(const Material &material, size_t index, Squares &squares) {
+    for (size_t i = material.count() - 1; i > 0; i--) {
+        squares[i] = static_cast<Square>(index % SQUARE_COUNT);
+        index /= SQUARE_COUNT;
+    }
+    squares[0] = static_cast<Square>(index % 32 / 4 * 8 + index % 4);
+    return static_cast<Color>(index / 32);
+}
+
+struct Table {
+    Material material;
+    // The mapped file, whose positions follow the header
+    const uint8_t *address;
+    size_t length;
+
+    Value value(size_t index) const {
+        return static_cast<Value>(address[HEADER_SIZE + index / 4] >> (2 * (index % 4)) & 3);
+    }
+};
+
+// A table is found by the material key of either side having its white pieces
+struct Entry {
+    size_t table;
+    bool swapped;
+};
+
+std::vector<Table> tables;
+std::unordered_map<uint64_t, Entry> keys;
+size_t max_pieces = 0;
+
+// Maps a file read only, or returns nullptr
+const uint8_t *Map(const std::string &path, size_t &length) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    void *address = MAP_FAILED;
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        length  = status.st_size;
+        address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (address == MAP_FAILED) return nullptr;
+    // Probes hit scattered positions, for which reading ahead is wasted
+    madvise(address, length, MADV_RANDOM);
+    return static_cast<const uint8_t *>(address);
+}
+
+bool Valid(const Table &table) {
+    uint32_t header[2];
+    const size_t size = table.material.size();
+    if (table.length != HEADER_SIZE + (size + 3) / 4) return false;
+    std::memcpy(header, table.address, HEADER_SIZE);
+    return header[0] == MAGIC && header[1] == size;
+}
+
+// Returns the attacks of a piece, where sliders stop at the first occupied square
+BB Attacks(Piece piece, Square sq, BB occupied) {
+    if (piece == KNIGHT || piece == KING) return ATTACKS[piece][sq];
+    BB attacks = 0;
+    for (const Direction dir : DIRECTIONS) {
+        const bool diagonal = dir >= NORTH_EAST;
+        if ((piece == ROOK && diagonal) || (piece == BISHOP && !diagonal)) continue;
+        BB ray = Ray(sq, dir);
+        if (const BB blockers = ray & occupied) {
+            // Rays towards higher squares are blocked by their lowest occupied square
+            const bool up = dir == NORTH || dir == EAST || dir == NORTH_EAST || dir == NORTH_WEST;
+            ray &= ~Ray(up ? lsb(blockers) : msb(blockers), dir);
+        }
+        attacks |= ray;
+    }
+    return attacks;
+}
+
+// Returns the squares a piece could have moved from to the square, without capturing
+BB Origins(Piece piece, Color color, Square to, BB occupied) {
+    if (piece != PAWN) return Attacks(piece, to, occupied) & ~occupied;
+    // A pawn is never on the first row, and steps two squares from its second
+    const int row  = (color == WHITE) ? Row(to) : 7 - Row(to);
+    const int back = (color == WHITE) ? -8 : 8;
+    const Square one = static_cast<Square>(to + back);
+    if (row < 2 || (occupied & ToBB(one))) return 0;
+    const Square two = static_cast<Square>(one + back);
+    return ToBB(one) | ((row == 3 && !(occupied & ToBB(two))) ? ToBB(two) : 0);
+}
+
+// Whether the pieces are on distinct squares, with pawns off the first and last rows, and
+// identical pieces ordered as by Index
+bool Valid(const Material &material, const Squares &squares) {
+    BB occupied = 0;
+    for (size_t i = 0; i < material.count(); i++) {
+        if (material.piece(i) == PAWN && (Row(squares[i]) == 0 || Row(squares[i]) == 7))
+            return false;
+        if (material.identical(i) && squares[i] < squares[i - 1]) return false;
+        occupied |= ToBB(squares[i]);
+    }
+    return static_cast<size_t>(popcount(occupied)) == material.count();
+}
+
+// Returns a board without pieces, which no FEN string describes
+Board Empty(Color turn) {
+    Position position;
+    SetState(position, turn, {Castling::None, Castling::None}, SQUARE_NONE);
+    return Board(position);
+}
+
+// Returns the best result of the en passant captures for the side to move, or UNKNOWN if it has
+// none, after a double push of the other side
+// The captures leave the ending, while declining them leads to the same position without the en
+// passant square, which is within it
+Value CaptureEnPassant(Board &board, std::atomic<bool> &missing) {
+    const Color turn = board.Turn();
+    Value value      = UNKNOWN;
+    for (const Move move : GenerateMovesTactical(board, turn)) {
+        if (!move.IsEnPassant()) continue;
+        board.ApplyMove(move);
+        if (board.IsKingSafe(turn)) {
+            const WDL wdl = Probe(board);
+            if (wdl == WDL::None) missing = true;
+            if (wdl == WDL::Loss) value = WIN;
+            if (wdl == WDL::Draw && value != WIN) value = DRAW;
+            if (wdl == WDL::Win && value == UNKNOWN) value = LOSS;
+        }
+        board.UndoMove(move);
+    }
+    return value;
+}
+
+// Returns CaptureEnPassant after the double push of the piece of index i to the square
+Value CaptureEnPassant(const Material &material, const Squares &squares, size_t i, Square to) {
+    Board board = Empty(material.color(i));
+    for (size_t j = 0; j < material.count(); j++)
+        board.PlacePiece(material.color(j), material.piece(j), squares[j]);
+    board.ApplyMove(Move(squares[i], to, Move::DoublePawnPush));
+    std::atomic<bool> missing = false;
+    return CaptureEnPassant(board, missing);
+}
+
+// Classifies a position by its moves which leave the ending, and by checkmate or stalemate
+// Counts the moves which are not known to lose, of which those within the ending are resolved
+// by the retrograde analysis, while those leaving it for a draw never are
+// A double push loses if an en passant capture wins, and is resolved here rather than retracted
+Value Classify(Board &board, uint8_t &remaining, std::atomic<bool> &missing) {
+    const Color turn = board.Turn();
+    if (!board.IsKingSafe(~turn)) return ILLEGAL;
+
+    Value value = UNKNOWN;
+    bool legal  = false;
+    remaining   = 0;
+    for (const Move move : GenerateMovesAll(board, turn)) {
+        board.ApplyMove(move);
+        if (board.IsKingSafe(turn)) {
+            legal = true;
+            if (move.IsCapture() || move.IsPromotion()) {
+                const WDL wdl = Probe(board);
+                if (wdl == WDL::None) missing = true;
+                if (wdl == WDL::Loss) value = WIN;
+                if (wdl == WDL::Draw) remaining++;
+            } else if (!move.IsDouble() || CaptureEnPassant(board, missing) != WIN)
+                remaining++;
+        }
+        board.UndoMove(move);
+    }
+
+    if (!legal) return board.IsKingSafe(turn) ? DRAW : LOSS;
+    return (value == UNKNOWN && remaining == 0) ? LOSS : value;
+}
+
+// Resolves the positions from which a move neither capturing nor promoting leads to the
+// resolved position, adding those which are to the found positions
+void Retract(
+    const Material &material, size_t index, std::vector<uint8_t> &results,
+    std::vector<uint8_t> &remaining, std::vector<size_t> &found
+) {
+    Squares squares;
+    const Color mover = ~Decode(material, index, squares);
+    const bool lost   = results[index] == LOSS;
+    BB occupied       = 0;
+    // Pawns which may capture en passant after a double push of the mover
+    BB capturers = 0;
+    for (size_t i = 0; i < material.count(); i++) {
+        occupied |= ToBB(squares[i]);
+        if (material.color(i) != mover && material.piece(i) == PAWN) capturers |= ToBB(squares[i]);
+    }
+
+    for (size_t i = 0; i < material.count(); i++) {
+        if (material.color(i) != mover) continue;
+        for (BB origins = Origins(material.piece(i), mover, squares[i], occupied); origins;) {
+            Squares prior     = squares;
+            prior[i]          = lsb_pop(origins);
+            const size_t from = Index(material, mover, prior);
+            std::atomic_ref<uint8_t> result(results[from]);
+            if (result.load(std::memory_order_relaxed) != UNKNOWN) continue;
+            // A double push after which an en passant capture wins was resolved by Classify,
+            // while one after which the capture holds the draw cannot win
+            const Square passed = static_cast<Square>((prior[i] + squares[i]) / 2);
+            if (material.piece(i) == PAWN && std::abs(Row(prior[i]) - Row(squares[i])) == 2 &&
+                (capturers & PawnAttacks(passed, mover))) {
+                const Value capture = CaptureEnPassant(material, prior, i, squares[i]);
+                if (capture == WIN || (capture == DRAW && lost)) continue;
+            }
+            // A move to a lost position wins, while only moves to won positions lose
+            uint8_t unknown = UNKNOWN;
+            if (lost) {
+                if (result.compare_exchange_strong(unknown, WIN)) found.push_back(from);
+            } else if (std::atomic_ref<uint8_t>(remaining[from]).fetch_sub(1) == 1 &&
+                       result.compare_exchange_strong(unknown, LOSS))
+                found.push_back(from);
+        }
+    }
+}
+
+// Calls f(thread, begin, end) for blocks of the range, which the threads take in turn
+template <typename F>
+void ParallelFor(size_t size, size_t threads, F f) {
+    constexpr size_t BLOCK = 1 << 12;
+    std::atomic<size_t> next = 0;
+    const auto work          = [&](size_t thread) {
+        for (size_t begin; (begin = next.fetch_add(BLOCK)) < size;)
+            f(thread, begin, std::min(begin + BLOCK, size));
+    };
+    std::vector<std::thread> workers;
+    for (size_t thread = 1; thread < threads; thread++)
+        workers.emplace_back(work, thread);
+    work(0);
+    for (auto &worker : workers)
+        worker.join();
+}
+
+std::vector<size_t> Join(std::vector<std::vector<size_t>> &found) {
+    std::vector<size_t> joined;
+    for (auto &positions : found) {
+        joined.insert(joined.end(), positions.begin(), positions.end());
+        positions.clear();
+    }
+    return joined;
+}
+} // namespace
+
+size_t Init(const std::string &directory) {
+    for (const Table &table : tables)
+        munmap(const_cast<uint8_t *>(table.address), table.length);
+    tables.clear();
+    keys.clear();
+    max_pieces = 0;
+    if (directory.empty()) return 0;
+
+    std::error_code error;
+    for (const auto &file : std::filesystem::directory_iterator(directory, error)) {
+        Table table;
+        if (file.path().extension() != EXTENSION ||
+            !Parse(file.path().stem().string(), table.material))
+            continue;
+        table.address = Map(file.path(), table.length);
+        if (table.address == nullptr) continue;
+        if (!Valid(table)) {
+            munmap(const_cast<uint8_t *>(table.address), table.length);
+            continue;
+        }
+        // Either key is the same for endings of equal material on each side
+        for (const bool swapped : {false, true})
+            keys.emplace(Key(table.material, swapped), Entry{tables.size(), swapped});
+        max_pieces = std::max(max_pieces, table.material.count());
+        tables.push_back(std::move(table));
+    }
+    return tables.size();
+}
+
+size_t MaxPieces() { return max_pieces; }
+
+WDL Probe(const Board &board) {
+    const size_t pieces = popcount(board.Pieces());
+    // Two kings alone need no table
+    if (pieces == 2) return WDL::Draw;
+    if (pieces > max_pieces || board.EP() != SQUARE_NONE ||
+        board.GetCastling(WHITE) != Castling::None || board.GetCastling(BLACK) != Castling::None)
+        return WDL::None;
+    const auto entry = keys.find(board.GetMaterialHash());
+    if (entry == keys.end()) return WDL::None;
+
+    // The table of the material with the colors swapped is probed with the rows mirrored
+    const Table &table       = tables[entry->second.table];
+    const bool swapped       = entry->second.swapped;
+    const int mirror         = swapped ? 56 : 0;
+    const Material &material = table.material;
+    Squares squares;
+    for (const Color side : {WHITE, BLACK})
+        squares[side] = Mirror(lsb(board.Pieces(swapped ? ~side : side, KING)), mirror);
+    size_t i = 2;
+    for (const Color side : {WHITE, BLACK}) {
+        BB remaining = board.Pieces(swapped ? ~side : side) & ~board.Pieces(KING);
+        for (const Piece piece : material.pieces[side]) {
+            const Square sq = lsb(remaining & board.Pieces(piece));
+            remaining ^= ToBB(sq);
+            squares[i++] = Mirror(sq, mirror);
+        }
+    }
+
+    const Color turn = swapped ? ~board.Turn() : board.Turn();
+    switch (table.value(Index(material, turn, squares))) {
+    case WIN: return WDL::Win;
+    case LOSS: return WDL::Loss;
+    case DRAW: return WDL::Draw;
+    default: return WDL::None;
+    }
+}
+
+size_t Generate(
+    const std::string &directory, size_t pieces, size_t threads,
+    const std::function<void(std::string_view, bool)> &report
+) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    Init(directory);
+    size_t generated = 0;
+    for (const std::string &name : Internal::Endings(pieces)) {
+        const bool success = Internal::GenerateTable(name, directory, threads);
+        if (report) report(name, success);
+        if (!success) return 0;
+        generated++;
+        Init(directory);
+    }
+    return generated;
+}
+
+namespace Internal {
+std::vector<std::string> Endings(size_t pieces) {
+    constexpr std::string_view PIECES = "QRBNP";
+    std::vector<std::string> endings;
+    for (const char a : PIECES) {
+        if (pieces >= 3) endings.push_back(std::string("K") + a + "vK");
+        if (pieces < 4) continue;
+        for (const char b : PIECES.substr(PIECES.find(a))) {
+            endings.push_back(std::string("K") + a + b + "vK");
+            endings.push_back(std::string("K") + a + "vK" + b);
+        }
+    }
+    // A capture leads to an ending of fewer pieces, and a promotion to one of fewer pawns
+    std::stable_sort(endings.begin(), endings.end(), [](const auto &l, const auto &r) {
+        return std::pair(l.size(), std::count(l.begin(), l.end(), 'P')) <
+               std::pair(r.size(), std::count(r.begin(), r.end(), 'P'));
+    });
+    return endings;
+}
+
+bool GenerateTable(std::string_view name, const std::string &directory, size_t threads) {
+    Material material;
+    if (!Parse(name, material)) return false;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t size = material.size();
+    std::vector<uint8_t> results(size);
+    // The moves of each position which are not yet known to lose
+    std::vector<uint8_t> remaining(size);
+    std::vector<std::vector<size_t>> found(threads);
+    std::atomic<bool> missing = false;
+
+    ParallelFor(size, threads, [&](size_t thread, size_t begin, size_t end) {
+        Board boards[COLOR_COUNT] = {Empty(WHITE), Empty(BLACK)};
+        for (size_t index = begin; index < end; index++) {
+            Squares squares;
+            Board &board = boards[Decode(material, index, squares)];
+            if (!Valid(material, squares)) {
+                results[index] = ILLEGAL;
+                continue;
+            }
+            for (size_t i = 0; i < material.count(); i++)
+                board.PlacePiece(material.color(i), material.piece(i), squares[i]);
+            results[index] = Classify(board, remaining[index], missing);
+            if (results[index] == WIN || results[index] == LOSS) found[thread].push_back(index);
+            for (size_t i = 0; i < material.count(); i++)
+                board.RemovePiece(material.color(i), material.piece(i), squares[i]);
+        }
+    });
+    // The endings which captures and promotions lead to must be generated first
+    if (missing) return false;
+
+    // Each resolved position resolves those it is reached from, until no more are
+    for (std::vector<size_t> wave = Join(found); !wave.empty(); wave = Join(found))
+        ParallelFor(wave.size(), threads, [&](size_t thread, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                Retract(material, wave[i], results, remaining, found[thread]);
+        });
+
+    // What remains unresolved is drawn, as neither side can force a result
+    std::vector<uint8_t> packed((size + 3) / 4);
+    for (size_t index = 0; index < size; index++) {
+        const uint8_t value = (results[index] == UNKNOWN) ? DRAW : results[index];
+        packed[index / 4] |= value << (2 * (index % 4));
+    }
+    const uint32_t header[2] = {MAGIC, static_cast<uint32_t>(size)};
+    std::ofstream file(
+        std::filesystem::path(directory) / (std::string(name) + std::string(EXTENSION)),
+        std::ios::binary
+    );
+    file.write(reinterpret_cast<const char *>(header), HEADER_SIZE);
+    file.write(reinterpret_cast<const char *>(packed.data()), packed.size());
+    // Writes may be buffered until closing, which must succeed as well
+    file.close();
+    return !file.fail();
+}
+} // namespace Internal
+} // namespace Tablebase
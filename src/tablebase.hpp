@@ -0,0 +1,45 @@
+#pragma once
+
+#include "board.hpp"
+#include "types.hpp"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Whether each position of few pieces is won, drawn or lost, found by retrograde analysis
+// The tables are generated ahead of time to files, which are memory mapped to be probed
+namespace Tablebase {
+// The result for the side to move, or None if the position is not in any table
+enum class WDL { Loss = -1, Draw = 0, Win = 1, None = 2 };
+
+// The most pieces, kings included, of the endings which are generated
+constexpr size_t MAX_PIECES = 4;
+
+// Maps the tables within the directory, in place of any mapped before
+// Returns the number of tables mapped, such that an empty path unmaps all
+size_t Init(const std::string &directory);
+// Returns the most pieces of any mapped table, or 0 if none are mapped
+size_t MaxPieces();
+// Returns the result of the position for the side to move
+// Positions with castling rights or an en passant square are not in any table
+// The fifty move rule is not accounted for
+WDL Probe(const Board &board);
+
+// Generates the tables of all endings of up to the given number of pieces to the directory
+// Those which captures and promotions lead to are generated, and mapped, first
+// The report is called after each ending with its name and whether it was generated
+// Returns the number of tables generated, or 0 if any failed
+size_t Generate(
+    const std::string &directory, size_t pieces = MAX_PIECES, size_t threads = 0,
+    const std::function<void(std::string_view, bool)> &report = nullptr
+);
+
+namespace Internal {
+// Returns the names of the endings of up to the given number of pieces, such as "KRvKN", in the
+// order they must be generated
+std::vector<std::string> Endings(size_t pieces);
+// Generates the table of a single ending, whose endings after captures and promotions are mapped
+bool GenerateTable(std::string_view name, const std::string &directory, size_t threads);
+} // namespace Internal
+} // namespace Tablebase
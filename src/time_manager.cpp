@@ -0,0 +1,71 @@
+#include "time_manager.hpp"
+#include <algorithm>
+
+namespace Search {
+namespace {
+// Number of moves assumed left when the time control does not specify it
+constexpr size_t DEFAULT_MOVES_TO_GO = 40;
+constexpr size_t MAX_MOVES_TO_GO     = 50;
+} // namespace
+
+TimeManager::TimeManager(const Limits &limits, Color us) {
+    if (limits.moveTime.has_value()) {
+        _managed = false;
+        _maximum = std::max<int64_t>(1, (int64_t)limits.moveTime.value() - MOVE_OVERHEAD);
+        _optimum = _maximum;
+    } else if (limits.infinite || !limits.time[us].has_value()) {
+        _managed = false;
+        _maximum = UNLIMITED;
+        _optimum = UNLIMITED;
+    } else {
+        _managed         = true;
+        const int64_t t  = limits.time[us].value();
+        const int64_t in = limits.inc[us];
+        const int64_t mtg =
+            limits.movesToGo ? std::min(limits.movesToGo, MAX_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+
+        // Time available for the remaining moves, each of which will also receive the increment
+        const int64_t budget = std::max<int64_t>(1, t + in * (mtg - 1) - (int64_t)MOVE_OVERHEAD);
+        // Never use more than most of what is left on the clock, leaving room for the next move
+        const int64_t share = (mtg == 1) ? 9 : 8;
+        const int64_t cap   = std::max<int64_t>(1, (t - (int64_t)MOVE_OVERHEAD) * share / 10);
+
+        _optimum = std::clamp<int64_t>(budget / mtg, 1, cap);
+        _maximum = std::clamp<int64_t>(_optimum * 5, 1, cap);
+    }
+}
+
+size_t TimeManager::Optimum() const { return _optimum; }
+size_t TimeManager::Maximum() const { return _maximum; }
+
+void TimeManager::Update(size_t iterationTime, Move bestMove, int score, double bestShare) {
+    // Estimate the growth of iterations from the last two, for predicting the next one
+    if (_iterationTime > 0 && iterationTime > 0)
+        _branching = std::clamp((double)iterationTime / _iterationTime, 1.5, 4.0);
+    _iterationTime = std::max<size_t>(iterationTime, 1);
+
+    // Recent changes of the best move count more than older ones
+    _bestMoveChanges /= 2;
+    if (_iterations > 0 && !(bestMove == _bestMove)) _bestMoveChanges += 1.0;
+
+    // Falling scores require more time to find a refutation
+    const double fall = (_iterations > 0) ? std::clamp(1.0 + (_score - score) / 100.0, 0.75, 1.5)
+                                          : 1.0;
+    // The larger the share of nodes beneath the best move, the more settled the search is
+    const double share = std::clamp(1.5 - bestShare, 0.6, 1.4);
+
+    _scale    = (1.0 + _bestMoveChanges) * fall * share;
+    _bestMove = bestMove;
+    _score    = score;
+    _iterations++;
+}
+
+bool TimeManager::ShouldStop(size_t elapsed) const {
+    if (!_managed) return false;
+
+    const size_t optimum = std::min<size_t>(_optimum * _scale, _maximum);
+    if (elapsed >= optimum) return true;
+    // Do not start an iteration which is not expected to finish before the hard limit
+    return elapsed + _iterationTime * _branching > _maximum;
+}
+} // namespace Search
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "move.hpp"
+#include "types.hpp"
+#include <optional>
+
+namespace Search {
+// The limits of a search, as given by the UCI go command
+// Zero denotes no limit for depth and nodes, and an unknown number of moves to go
+struct Limits {
+    std::optional<size_t> time[COLOR_COUNT];
+    size_t inc[COLOR_COUNT] = {0, 0};
+    size_t movesToGo        = 0;
+    std::optional<size_t> moveTime;
+    size_t depth  = 0;
+    size_t nodes  = 0;
+    // Searches for a mate in at most this many moves, rather than for the best move
+    size_t mate   = 0;
+    bool infinite = false;
+    bool ponder   = false;
+};
+
+// Allocates time for a single move
+//
+// The optimum is a soft limit, checked between iterations and scaled by the stability of the
+// search. The maximum is a hard limit, upon which the search is stopped.
+class TimeManager {
+public:
+    static constexpr size_t UNLIMITED     = SIZE_MAX;
+    static constexpr size_t MOVE_OVERHEAD = 30;
+
+    TimeManager(const Limits &limits, Color us);
+
+    // Returns the soft time limit in ms
+    size_t Optimum() const;
+    // Returns the hard time limit in ms
+    size_t Maximum() const;
+    // Updates the scaling of the optimum from the result of a finished iteration
+    void Update(size_t iterationTime, Move bestMove, int score, double bestShare);
+    // Returns whether the search should stop after the elapsed time in ms, rather than start
+    // another iteration
+    bool ShouldStop(size_t elapsed) const;
+
+private:
+    size_t _optimum;
+    size_t _maximum;
+    bool _managed;
+
+    double _scale           = 1.0;
+    double _bestMoveChanges = 0.0;
+    double _branching       = 2.0;
+    size_t _iterationTime   = 0;
+    size_t _iterations      = 0;
+    Move _bestMove;
+    int _score = 0;
+};
+} // namespace Search
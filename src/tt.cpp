@@ -3,77 +3,87 @@
 
 namespace TT {
 
+// Packed, such that three entries fit a cacheline
+#pragma pack(push, 2)
 struct Entry {
     uint64_t key  = 0;
-    int value     = 0;
+    int32_t value = 0;
+    int16_t eval  = NoEval;
     Move move     = Move();
     uint8_t depth = 0;
     int8_t type   = ProbeFail;
 };
+#pragma pack(pop)
 
-struct Bucket {
-    static const int COUNT = 2;
+struct alignas(64) Bucket {
+    static const int COUNT = 3;
     std::array<Entry, COUNT> entries;
     Entry &operator[](size_t i) { return entries[i]; }
     const Entry &operator[](size_t i) const { return entries[i]; }
 };
 
-// Sized to cacheline (maybe...)
-static_assert(sizeof(Bucket) == 32);
+static_assert(sizeof(Entry) == 18);
+static_assert(sizeof(Bucket) == 64);
 
-size_t count = 0;
-Bucket *tt   = nullptr;
+namespace {
+Table shared;
+// The table accessed by the calling thread
+thread_local Table *current = &shared;
+} // namespace
+
+void Init(size_t tableSize) { Init(shared, tableSize); }
+void Clean() { Clean(shared); }
 
-void Init(size_t tableSize) {
+void Init(Table &table, size_t tableSize) {
     tableSize *= 1024 * 1024;
-    count = tableSize / sizeof(Bucket);
-    tt    = new Bucket[count];
+    table.count   = tableSize / sizeof(Bucket);
+    table.buckets = new Bucket[table.count];
 }
 
-void Clean() {
-    if (count != 0) {
-        count = 0;
-        delete[] tt;
+void Clean(Table &table) {
+    if (table.count != 0) {
+        table.count = 0;
+        delete[] table.buckets;
     }
 }
 
+void Bind(Table *table) { current = (table != nullptr) ? table : &shared; }
+
 size_t HashFull() {
-    size_t hashfull = 0;
+    const Bucket *tt = current->buckets;
+    size_t hashfull  = 0;
 
-    for (size_t i = 0; i < count; i++)
+    for (size_t i = 0; i < current->count; i++)
         for (size_t t = 0; t < Bucket::COUNT; t++)
             if (tt[i][t].key != 0) hashfull++;
 
-    return hashfull * 1000 / count / Bucket::COUNT;
+    return hashfull * 1000 / current->count / Bucket::COUNT;
 }
 
 namespace {
+// Mates and tablebase wins are stored relative to the position, rather than the root, such that
+// an entry holds wherever the position is found again
 int EvalStore(int score, int ply) {
-    if (score != Values::INF)
-        return score;
-    else {
-        const int sign = (score > 0) ? 1 : -1;
-        return (score * sign + ply) * sign;
-    }
+    if (score >= Values::DISTANCE_BOUND) return score + ply;
+    if (score <= -Values::DISTANCE_BOUND) return score - ply;
+    return score;
 }
 int EvalRetrieve(int score, int ply) {
-    if (score != Values::INF)
-        return score;
-    else {
-        const int sign = (score > 0) ? 1 : -1;
-        return (score * sign - ply) * sign;
-    }
+    if (score >= Values::DISTANCE_BOUND) return score - ply;
+    if (score <= -Values::DISTANCE_BOUND) return score + ply;
+    return score;
 }
 } // namespace
 
 Result Probe(uint64_t key, int depth, int searchDepth, int alpha, int beta) {
     Result result{.score = ProbeFail};
-    const Bucket &bucket = tt[key % count];
+    const Bucket &bucket = current->buckets[key % current->count];
     for (size_t i = 0; i < Bucket::COUNT; i++) {
         const Entry &entry = bucket[i];
         if (entry.key != key) continue;
 
         result.move = entry.move;
+        result.eval = entry.eval;
 
         // Only a single copy is stored of each position
         // As such, if one is found but is of low depth
@@ -93,19 +103,21 @@ Result Probe(uint64_t key, int depth, int searchDepth, int alpha, int beta) {
 }
 
 Move ProbeMove(uint64_t key) {
-    Bucket &bucket = tt[key % count];
+    Bucket &bucket = current->buckets[key % current->count];
     for (size_t i = 0; i < Bucket::COUNT; i++)
         if (const Entry &entry = bucket[i]; entry.key == key) return entry.move;
     return Move();
 }
 
 void Clear() {
-    for (size_t i = 0; i < count; i++)
-        tt[i] = Bucket();
+    for (size_t i = 0; i < current->count; i++)
+        current->buckets[i] = Bucket();
 }
 
-void StoreEval(uint64_t key, int depth, int searchDepth, int value, int evalType, Move move) {
-    Bucket &bucket = tt[key % count];
+void StoreEval(
+    uint64_t key, int depth, int searchDepth, int value, int evalType, Move move, int staticEval
+) {
+    Bucket &bucket = current->buckets[key % current->count];
 
     // First pass check if key already stored
     // Avoids duplicate storage
@@ -115,7 +127,16 @@ void StoreEval(uint64_t key, int depth, int searchDepth, int value, int evalType
             i == Bucket::COUNT - 1 ||    // Last entry
             entry.key == key) [[likely]] // Entry override
         {
+            if (entry.key == key && entry.type != ProbeFail) {
+                if (staticEval == NoEval) staticEval = entry.eval;
+                // Quiescence results only lend their static evaluation to deeper entries
+                if (depth == 0 && entry.depth > 0) {
+                    entry.eval = staticEval;
+                    break;
+                }
+            }
             entry.type  = evalType;
+            entry.eval  = staticEval;
             entry.value = EvalStore(value, searchDepth);
             entry.depth = depth;
             entry.key   = key;
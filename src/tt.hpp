@@ -10,15 +10,33 @@ static const int ProbeExact = 0;
 static const int ProbeLower = 1;
 static const int ProbeUpper = 2;
 
+// Marks an entry without the static evaluation of its position
+static const int NoEval = -32768;
+
 struct Result {
     int score = -1;
     Move move = Move();
+    int eval  = NoEval;
+};
+
+struct Bucket;
+
+// The entries of a table, of which Init allocates the one shared by all threads
+struct Table {
+    Bucket *buckets = nullptr;
+    size_t count    = 0;
 };
 
 // startup / cleanup
 
 void Init(size_t tableSize = DEFAULT_HASH_SIZE);
 void Clean();
+// Allocates and frees a table of its own, for searches which must not share one, such as those of
+// concurrent games
+void Init(Table &table, size_t tableSize);
+void Clean(Table &table);
+// Makes the calling thread access the table, in place of the shared one, until bound to null
+void Bind(Table *table);
 
 // access
 
@@ -30,6 +48,11 @@ Move ProbeMove(uint64_t key);
 // modifiers
 
 void Clear();
-void StoreEval(uint64_t key, int depth, int searchDepth, int value, int evalType, Move move);
+// The static evaluation is kept from a prior entry of the position, if none is given
+// Entries of depth 0, as stored by the quiescence search, do not replace deeper ones
+void StoreEval(
+    uint64_t key, int depth, int searchDepth, int value, int evalType, Move move,
+    int staticEval = NoEval
+);
 
 } // namespace TT
@@ -35,7 +35,7 @@ enum Direction {
     SOUTH_WEST,
     DIRECTION_NONE
 };
-enum class Castling : uint16_t { None, King, Queen, All };
+enum class Castling : uint8_t { None, King, Queen, All };
 enum class Row : BB {
     Row1 = 0xff,
     Row2 = 0xff00,
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "score.hpp"
+#include "types.hpp"
 #include <array>
 #include <cstddef>
 
@@ -10,32 +12,39 @@ constexpr std::array<int, 64> C(std::array<int, 64> a, int b) {
         a[i] += b;
     return a;
 }
-template <int s = 64>
-constexpr std::array<int, s> I(std::array<int, s> array) {
-    std::array<int, s> newArray;
-    for (size_t i = 0; i < array.size(); i++)
-        newArray[i] = array.at(s - 1 - i);
-    return newArray;
-}
 } // namespace
 constexpr int PHASE_INC[6] = {0, 1, 1, 2, 4, 0};
 constexpr int INF          = 99999;
-namespace Structure {
-namespace DoubledPawn {
-constexpr int MG = -20;
-constexpr int EG = -30;
-} // namespace DoubledPawn
-namespace PassedPawn {
-constexpr std::array<int, 8> MG_WHITE = {0, 0, 5, 10, 20, 40, 80, 0};
-constexpr std::array<int, 8> EG_WHITE = {0, 10, 10, 20, 20, 60, 80, 0};
+// Evaluation of an ending known to be won, above any evaluation of material alone
+constexpr int KNOWN_WIN = 10000;
+// Value of a position the tablebases show to be won, above any evaluation
+constexpr int TB_WIN = 50000;
+// Value of mating at the root, of which a point is taken for each ply to the mate, such that
+// shorter mates are preferred
+constexpr int MATE = 90000;
+// Values of mates lie beyond this bound
+constexpr int MATE_BOUND = MATE - static_cast<int>(MAX_PLY);
+// Values of mates and tablebase wins lie beyond this bound, which are relative to the ply they
+// are found at
+constexpr int DISTANCE_BOUND = TB_WIN - static_cast<int>(MAX_PLY);
 
-constexpr std::array<std::array<int, 8>, 2> MG = {MG_WHITE, I<8>(MG_WHITE)};
-constexpr std::array<std::array<int, 8>, 2> EG = {EG_WHITE, I<8>(EG_WHITE)};
-} // namespace PassedPawn
-namespace IsolatedPawn {
-constexpr int MG = -5;
-constexpr int EG = -10;
-} // namespace IsolatedPawn
+constexpr int MatedIn(int ply) { return -MATE + ply; }
+constexpr int MateIn(int ply) { return MATE - ply; }
+constexpr bool IsMate(int value) { return value >= MATE_BOUND || value <= -MATE_BOUND; }
+namespace Structure {
+constexpr Score DoubledPawn  = Score(-20, -30);
+constexpr Score IsolatedPawn = Score(-5, -10);
+// Indexed by color and row
+constexpr std::array<std::array<Score, 8>, 2> PassedPawn = [] {
+    constexpr std::array<int, 8> MG = {0, 0, 5, 10, 20, 40, 80, 0};
+    constexpr std::array<int, 8> EG = {0, 10, 10, 20, 20, 60, 80, 0};
+    std::array<std::array<Score, 8>, 2> passed{};
+    for (size_t row = 0; row < 8; row++) {
+        passed[0][row]     = Score(MG[row], EG[row]);
+        passed[1][7 - row] = passed[0][row];
+    }
+    return passed;
+}();
 } // namespace Structure
 namespace Material {
 namespace Pawn {
@@ -209,32 +218,31 @@ constexpr std::array<int, 64> EG = {
 } // namespace King
 // clang-format on
 } // namespace Position
-inline std::array<std::array<int, 64>, 6> MG_BLACK = {
-    C(Position::Pawn::MG, Material::Pawn::MG),     C(Position::Knight::MG, Material::Knight::MG),
-    C(Position::Bishop::MG, Material::Bishop::MG), C(Position::Rook::MG, Material::Rook::MG),
-    C(Position::Queen::MG, Material::Queen::MG),   C(Position::King::MG, 0)
-};
-inline std::array<std::array<int, 64>, 6> MG_WHITE = {
-    C(I<64>(Position::Pawn::MG), Material::Pawn::MG),
-    C(I<64>(Position::Knight::MG), Material::Knight::MG),
-    C(I<64>(Position::Bishop::MG), Material::Bishop::MG),
-    C(I<64>(Position::Rook::MG), Material::Rook::MG),
-    C(I<64>(Position::Queen::MG), Material::Queen::MG),
-    C(I<64>(Position::King::MG), 0)
-};
-inline std::array<std::array<int, 64>, 6> EG_BLACK = {
-    C(Position::Pawn::EG, Material::Pawn::EG),     C(Position::Knight::EG, Material::Knight::EG),
-    C(Position::Bishop::EG, Material::Bishop::EG), C(Position::Rook::EG, Material::Rook::EG),
-    C(Position::Queen::EG, Material::Queen::EG),   C(Position::King::EG, 0)
-};
-inline std::array<std::array<int, 64>, 6> EG_WHITE = {
-    C(I<64>(Position::Pawn::EG), Material::Pawn::EG),
-    C(I<64>(Position::Knight::EG), Material::Knight::EG),
-    C(I<64>(Position::Bishop::EG), Material::Bishop::EG),
-    C(I<64>(Position::Rook::EG), Material::Rook::EG),
-    C(I<64>(Position::Queen::EG), Material::Queen::EG),
-    C(I<64>(Position::King::EG), 0)
-};
-inline std::array<std::array<std::array<int, 64>, 6>, 2> MG{MG_WHITE, MG_BLACK};
-inline std::array<std::array<std::array<int, 64>, 6>, 2> EG{EG_WHITE, EG_BLACK};
+// The value of each piece on each square, including its material, indexed by color and piece
+constexpr std::array<std::array<std::array<Score, 64>, 6>, 2> PSQ = [] {
+    constexpr std::array<std::array<int, 64>, 6> MG = {
+        C(Position::Pawn::MG, Material::Pawn::MG),
+        C(Position::Knight::MG, Material::Knight::MG),
+        C(Position::Bishop::MG, Material::Bishop::MG),
+        C(Position::Rook::MG, Material::Rook::MG),
+        C(Position::Queen::MG, Material::Queen::MG),
+        C(Position::King::MG, 0)
+    };
+    constexpr std::array<std::array<int, 64>, 6> EG = {
+        C(Position::Pawn::EG, Material::Pawn::EG),
+        C(Position::Knight::EG, Material::Knight::EG),
+        C(Position::Bishop::EG, Material::Bishop::EG),
+        C(Position::Rook::EG, Material::Rook::EG),
+        C(Position::Queen::EG, Material::Queen::EG),
+        C(Position::King::EG, 0)
+    };
+    std::array<std::array<std::array<Score, 64>, 6>, 2> psq{};
+    // The tables are for black, and are reversed for white
+    for (size_t piece = 0; piece < 6; piece++)
+        for (size_t sq = 0; sq < 64; sq++) {
+            psq[1][piece][sq]      = Score(MG[piece][sq], EG[piece][sq]);
+            psq[0][piece][63 - sq] = psq[1][piece][sq];
+        }
+    return psq;
+}();
 } // namespace Values
@@ -1,34 +1,110 @@
 #include "zobrist.hpp"
+#include "bitboard.hpp"
 #include <array>
+#include <utility>
 
-constexpr int SQUARE_HASH_COUNT = 2 * 6 * 64;
-// Generate hashses in a pseudo-random way
-// Cannot use *actual* randomness as its compile time
-// This is, however, good enough
-constexpr std::array<uint64_t, SQUARE_HASH_COUNT> HASHES = [] {
-    auto tempTable = decltype(HASHES){};
+namespace {
+struct Keys {
+    std::array<std::array<std::array<uint64_t, SQUARE_COUNT>, PIECE_COUNT>, COLOR_COUNT> squares;
+    std::array<std::array<uint64_t, 4>, COLOR_COUNT> castling;
+    std::array<uint64_t, SQUARE_COUNT + 1> ep;
+    std::array<std::array<uint64_t, PIECE_COUNT>, COLOR_COUNT> material;
+    uint64_t color;
+};
 
-    uint64_t lfsr = 0x181818ffff181818;
-    uint64_t bit;
+// Generate hashes with SplitMix64
+// Cannot use *actual* randomness as its compile time, but the output is well mixed
+constexpr Keys KEYS = [] {
+    Keys keys{};
+    uint64_t state = 0x9e3779b97f4a7c15;
+    auto next      = [&state]() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15);
+        z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z          = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    };
 
-    for (int i = 0; i < SQUARE_HASH_COUNT; i++) {
-        bit          = ((lfsr >> 0) ^ (lfsr >> 2) ^ (lfsr >> 3) ^ (lfsr >> 5)) & 1u;
-        lfsr         = (lfsr >> 1) | (bit << 63);
-        tempTable[i] = lfsr;
+    for (auto &color : keys.squares)
+        for (auto &piece : color)
+            for (uint64_t &key : piece)
+                key = next();
+    // Combined rights are keyed as the combination of each, such that one flip suffices
+    for (auto &color : keys.castling) {
+        color[(size_t)Castling::None]  = 0;
+        color[(size_t)Castling::King]  = next();
+        color[(size_t)Castling::Queen] = next();
+        color[(size_t)Castling::All]   = color[(size_t)Castling::King] ^
+                                       color[(size_t)Castling::Queen];
     }
+    for (size_t sq = 0; sq < SQUARE_COUNT; sq++)
+        keys.ep[sq] = next();
+    keys.ep[SQUARE_COUNT] = 0;
+    for (auto &color : keys.material)
+        for (uint64_t &key : color)
+            key = next();
+    keys.color = next();
 
-    return tempTable;
+    return keys;
 }();
 
-void Zobrist::FlipSquare(uint64_t& hash, Square square, Piece type, Color color) {
-    hash ^= HASHES[(64 * 6) * (int)color + 64 * (int)type + (int)square];
+// A cuckoo hash table of the hash difference of each move by a piece, other than a pawn, on an
+// otherwise empty board
+// There are 3668 such moves, which fit without collisions, each key being in one of two slots
+struct Cuckoo {
+    static constexpr size_t SIZE = 8192;
+    std::array<uint64_t, SIZE> keys{};
+    std::array<Move, SIZE> moves{};
+
+    static constexpr size_t H1(uint64_t key) { return key & (SIZE - 1); }
+    static constexpr size_t H2(uint64_t key) { return (key >> 16) & (SIZE - 1); }
+};
+
+// Depends on the attack tables, so cannot be generated at compile time
+const Cuckoo CUCKOO = [] {
+    Cuckoo cuckoo;
+    for (const Color color : {WHITE, BLACK})
+        for (const Piece piece : {KNIGHT, BISHOP, ROOK, QUEEN, KING})
+            for (size_t from = 0; from < SQUARE_COUNT; from++)
+                for (size_t to = from + 1; to < SQUARE_COUNT; to++) {
+                    if (!(ATTACKS[piece][from] & static_cast<Square>(to))) continue;
+                    uint64_t key = KEYS.squares[color][piece][from] ^
+                                   KEYS.squares[color][piece][to] ^ KEYS.color;
+                    Move move(static_cast<Square>(from), static_cast<Square>(to), Move::Quiet);
+                    // Insert, moving whichever entry is in the way to its other slot
+                    for (size_t i = Cuckoo::H1(key);; i = (i == Cuckoo::H1(key))
+                                                              ? Cuckoo::H2(key)
+                                                              : Cuckoo::H1(key)) {
+                        std::swap(cuckoo.keys[i], key);
+                        std::swap(cuckoo.moves[i], move);
+                        if (!move.IsDefined()) break;
+                    }
+                }
+    return cuckoo;
+}();
+} // namespace
+
+void Zobrist::FlipSquare(uint64_t &hash, Square square, Piece type, Color color) {
+    hash ^= KEYS.squares[color][type][square];
+}
+
+void Zobrist::FlipCastling(uint64_t &hash, Color col, Castling side) {
+    hash ^= KEYS.castling[col][(size_t)side];
+}
+
+void Zobrist::FlipEnPassant(uint64_t &hash, Square sq) { hash ^= KEYS.ep[sq]; }
+
+void Zobrist::FlipColor(uint64_t &hash) { hash ^= KEYS.color; }
+
+void Zobrist::AddMaterial(uint64_t &hash, Piece type, Color color) {
+    hash += KEYS.material[color][type];
 }
 
-void Zobrist::FlipCastling(uint64_t& hash, Color col, Castling side) {
-    hash ^= HASHES[SQUARE_HASH_COUNT + 2 * (int)col + (int)side];
+void Zobrist::RemoveMaterial(uint64_t &hash, Piece type, Color color) {
+    hash -= KEYS.material[color][type];
 }
 
-void Zobrist::FlipEnPassant(uint64_t& hash, Square sq) {
-    hash ^= HASHES[SQUARE_HASH_COUNT + 4 + sq];
+Move Zobrist::ReversibleMove(uint64_t difference) {
+    if (size_t i = Cuckoo::H1(difference); CUCKOO.keys[i] == difference) return CUCKOO.moves[i];
+    if (size_t i = Cuckoo::H2(difference); CUCKOO.keys[i] == difference) return CUCKOO.moves[i];
+    return Move();
 }
-void Zobrist::FlipColor(uint64_t& hash) { hash ^= 0xaa55aa55aa55aa55; }
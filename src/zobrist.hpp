@@ -1,10 +1,21 @@
 #pragma once
 
+#include "move.hpp"
 #include "types.hpp"
 
 namespace Zobrist {
 void FlipSquare(uint64_t &hash, Square square, Piece type, Color color);
+// Flips the castling rights of a color, such that None has no effect
 void FlipCastling(uint64_t &hash, Color col, Castling side);
+// Flips the en passant square, such that SQUARE_NONE has no effect
 void FlipEnPassant(uint64_t &hash, Square sq);
 void FlipColor(uint64_t &hash);
+// Keeps a hash of the material only, regardless of where the pieces are
+// Each piece adds its key, such that the hash is a sum over the count of each piece
+void AddMaterial(uint64_t &hash, Piece type, Color color);
+void RemoveMaterial(uint64_t &hash, Piece type, Color color);
+// Returns the move of a piece, other than a pawn, between two squares, whose hash difference,
+// including the change of side to move, is the given one
+// In case that no such move exists, an undefined move is returned
+Move ReversibleMove(uint64_t difference);
 } // namespace Zobrist
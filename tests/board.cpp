@@ -188,7 +188,7 @@ TEST_SUITE("BOARD::UPDATE") {
         CHECK_EQ(board.GetHash(), prior_hash);
     }
     TEST_CASE("EP") {
-        Board board = Board("8/8/8/8/1p6/8/P7/8 w - - 0 1", "a2a4");
+        Board board = Board("4k3/8/8/8/1p6/8/P7/4K3 w - - 0 1", "a2a4");
 
         const uint64_t prior_hash = board.GetHash();
         CHECK_EQ(board.EP(), A3);
@@ -201,9 +201,107 @@ TEST_SUITE("BOARD::UPDATE") {
         CHECK_EQ(board.Pieces(PAWN), 0x3000000);
         CHECK_EQ(board.GetHash(), prior_hash);
     }
+    TEST_CASE("COPY") {
+        Board board = Board(FEN_START, "e2e4 e7e5 g1f3");
+        Board copy  = board;
+        CHECK_EQ(copy.Ply(), 3);
+        CHECK_EQ(copy.GetHash(), board.GetHash());
+        copy.UndoMove(Move(G1, F3, Move::Quiet));
+        CHECK_EQ(copy.Ply(), 2);
+        CHECK_EQ(copy.SquarePiece(G1), KNIGHT);
+        CHECK_EQ(board.SquarePiece(F3), KNIGHT);
+        CHECK_NE(copy.GetHash(), board.GetHash());
+        copy.ApplyMove(Move(G1, F3, Move::Quiet));
+        CHECK_EQ(copy.GetHash(), board.GetHash());
+    }
+    TEST_CASE("PIECE SQUARE") {
+        const std::array<std::array<std::string, 3>, 3> cases = {{
+            {FEN_START, "e2e4 d7d5 e4d5 d8d5",
+             "rnb1kbnr/ppp1pppp/8/3q4/8/8/PPPP1PPP/RNBQKBNR w KQkq - 0 3"},
+            {"4k3/8/8/8/8/8/8/4K2R w K - 0 1", "e1g1", "4k3/8/8/8/8/8/8/5RK1 b - - 1 1"},
+            {"1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", "1Q2k3/8/8/8/8/8/8/4K3 b - - 0 1"},
+        }};
+        for (const auto &[fen, moves, result] : cases) {
+            const Board board    = Board(fen, moves);
+            const Board expected = Board(result);
+            CHECK_EQ(board.GetPieceSquare(), expected.GetPieceSquare());
+            CHECK_EQ(board.GetPhase(), expected.GetPhase());
+        }
+        CHECK_EQ(Board().GetPhase(), 24);
+    }
     TEST_CASE("THREEFOLD") {
         Board board =
             Board(FEN_START, "b1c3 b8c6 c3b1 c6b8 b1c3 b8c6 c3b1 c6b8 b1c3 b8c6 c3b1 c6b8");
         CHECK(board.IsThreefold());
     }
+    TEST_CASE("REPETITION") {
+        Board board = Board(FEN_START, "b1c3 b8c6 c3b1 c6b8");
+        CHECK_FALSE(board.IsThreefold());
+        CHECK_FALSE(board.IsRepetition(3));
+        CHECK(board.IsRepetition(4));
+        // A pawn move makes the earlier positions unreachable
+        board = Board(FEN_START, "b1c3 b8c6 c3b1 c6b8 e2e4 e7e5 b1c3 b8c6 c3b1 c6b8");
+        CHECK(board.IsRepetition(4));
+        CHECK_FALSE(board.IsRepetition(0));
+    }
+    TEST_CASE("UPCOMING REPETITION") {
+        // Black can return the knight to g8
+        Board board = Board(FEN_START, "g1f3 g8f6 f3g1");
+        CHECK(board.IsRepetitionUpcoming(3));
+        CHECK_FALSE(board.IsRepetitionUpcoming(2));
+        // White has to move both knights to reach any earlier position
+        board = Board(FEN_START, "g1f3 g8f6 f3g1 f6g4");
+        CHECK_FALSE(board.IsRepetitionUpcoming(4));
+        // Black can return the king to d8
+        board = Board("4k3/8/8/8/8/8/8/R3K3 w - - 0 1", "a1a4 e8d8 e1e2 d8e8 e2e1");
+        CHECK(board.IsRepetitionUpcoming(5));
+        CHECK_FALSE(board.IsRepetitionUpcoming(1));
+    }
+    TEST_CASE("HALFMOVE") {
+        Board board = Board("8/8/4k3/8/8/3K4/8/7R w - - 98 70", "h1h2 e6e5");
+        CHECK_EQ(board.HalfMoveClock(), 100);
+        CHECK_EQ(board.FullMoveNumber(), 71);
+        CHECK(board.IsFiftyMoves());
+        board.UndoMove(Move(E6, E5, Move::Quiet));
+        CHECK_EQ(board.HalfMoveClock(), 99);
+        CHECK_EQ(board.FullMoveNumber(), 70);
+        CHECK_FALSE(board.IsFiftyMoves());
+        board = Board(FEN_START, "e2e4");
+        CHECK_EQ(board.HalfMoveClock(), 0);
+        CHECK_EQ(board.FullMoveNumber(), 1);
+        board = Board("rnbqkbnr/pppp1ppp/8/8/3pP3/8/PPP2PPP/RNBQKBNR b KQkq e3 0 3", "");
+        CHECK_EQ(board.EP(), E3);
+        const Board pushed("rnbqkbnr/pppp1ppp/8/8/3p4/8/PPP1PPPP/RNBQKBNR w KQkq - 0 3", "e2e4");
+        CHECK_EQ(board.GetHash(), pushed.GetHash());
+    }
+    TEST_CASE("CASTLING HASH") {
+        // Equal placement, though only the first may still castle
+        const Board castle = Board("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "");
+        const Board moved  = Board("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1d1 e8d8 d1e1 d8e8");
+        const Board fen    = Board("r3k2r/8/8/8/8/8/8/R3K2R w - - 0 1", "");
+        CHECK_NE(castle.GetHash(), moved.GetHash());
+        CHECK_EQ(moved.GetHash(), fen.GetHash());
+        const Board rook = Board("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "h1h2 a8a7 h2h1 a7a8");
+        CHECK_EQ(rook.GetHash(), Board("r3k2r/8/8/8/8/8/8/R3K2R w Qk - 0 1", "").GetHash());
+    }
+    TEST_CASE("PAWN AND MATERIAL HASH") {
+        Board board          = Board(FEN_START, "g1f3");
+        const Board start    = Board();
+        const uint64_t pawns = board.GetPawnHash();
+        CHECK_EQ(pawns, start.GetPawnHash());
+        CHECK_EQ(board.GetMaterialHash(), start.GetMaterialHash());
+        board.ApplyMove(Move(E7, E5, Move::DoublePawnPush));
+        CHECK_NE(board.GetPawnHash(), pawns);
+        CHECK_EQ(board.GetMaterialHash(), start.GetMaterialHash());
+        board.ApplyMove(Move(F3, E5, Move::Capture));
+        // Only the placement of pawns, and the count of each piece, matter
+        const Board same = Board("4k3/pppp1ppp/8/8/8/8/PPPPPPPP/4K3 w - - 0 1");
+        const Board less = Board("rnbqkbnr/ppp1pppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+        CHECK_EQ(board.GetPawnHash(), same.GetPawnHash());
+        CHECK_EQ(board.GetMaterialHash(), less.GetMaterialHash());
+        board.UndoMove(Move(F3, E5, Move::Capture));
+        board.UndoMove(Move(E7, E5, Move::DoublePawnPush));
+        CHECK_EQ(board.GetPawnHash(), pawns);
+        CHECK_EQ(board.GetMaterialHash(), start.GetMaterialHash());
+    }
 }
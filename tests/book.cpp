@@ -0,0 +1,111 @@
+#include "board.hpp"
+#include "book.hpp"
+#include "third_party/doctest.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+struct BookEntry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;
+};
+
+// The squares are cast, as a square would be taken as a bitboard by operator|
+uint16_t BookMove(Square from, Square to, size_t promotion = 0) {
+    return static_cast<uint16_t>(promotion << 12 | size_t(from) << 6 | size_t(to));
+}
+
+// Writes the entries sorted by key, as the format requires
+void WriteBook(const std::string &path, std::vector<BookEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const auto &l, const auto &r) {
+        return l.key < r.key;
+    });
+    std::ofstream file(path, std::ios::binary);
+    const auto write = [&file](uint64_t value, size_t size) {
+        for (size_t i = size; i-- > 0;)
+            file.put(static_cast<char>(value >> (8 * i)));
+    };
+    for (const BookEntry &entry : entries) {
+        write(entry.key, 8);
+        write(entry.move, 2);
+        write(entry.weight, 2);
+        write(0, 4);
+    }
+}
+} // namespace
+
+TEST_SUITE("BOOK") {
+    TEST_CASE("KEY") {
+        // The keys given by the specification of the format
+        const std::pair<std::string, uint64_t> positions[] = {
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463B96181691FC9C},
+            {"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823C9B50FD114196},
+            {"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756B94461C50FB0},
+            {"rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662FAFB965DB29D4},
+            {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22A48B5A8E47FF78},
+            {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652A607CA3F242C1},
+            {"rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00FDD303C946BDD9},
+            {"rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3C8123EA7B067637},
+            {"rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5C3F9B829B279560},
+        };
+        for (const auto &[fen, key] : positions)
+            CHECK_EQ(Book::Key(Board(fen)), key);
+
+        // The en passant square only counts if a pawn can capture upon it
+        CHECK_EQ(
+            Book::Key(Board("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1")),
+            Book::Key(Board("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"))
+        );
+        CHECK_NE(
+            Book::Key(Board("rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1")),
+            Book::Key(Board("rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"))
+        );
+    }
+
+    TEST_CASE("PROBE") {
+        const std::string path = std::filesystem::temp_directory_path() / "sunbird_test.bin";
+        const Board start      = Board();
+        const Board castling   = Board("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+        const Board promotion  = Board("8/P6k/8/8/8/8/8/K7 w - - 0 1");
+        WriteBook(
+            path, {
+                      {Book::Key(start), BookMove(E2, E4), 10},
+                      {Book::Key(start), BookMove(D2, D4), 30},
+                      // Not a legal move, which is skipped
+                      {Book::Key(start), BookMove(E2, E5), 100},
+                      {Book::Key(castling), BookMove(E1, H1), 1},
+                      {Book::Key(promotion), BookMove(A7, A8, 4), 1},
+                      {Book::Key(promotion), BookMove(A7, A8, 1), 0},
+                  }
+        );
+        CHECK_FALSE(Book::Enabled());
+        REQUIRE(Book::Open(path));
+        CHECK(Book::Enabled());
+
+        CHECK_EQ(Book::Moves(start).size(), 2);
+        CHECK_EQ(Book::Probe(start, true).Export(), "d2d4");
+        // The moves are chosen by their weights, with a fixed seed such that the counts are too
+        Book::Internal::Seed(1);
+        size_t d4 = 0;
+        for (size_t i = 0; i < 1000; i++) {
+            const std::string move = Book::Probe(start).Export();
+            CHECK((move == "d2d4" || move == "e2e4"));
+            d4 += (move == "d2d4");
+        }
+        CHECK_GT(d4, 600);
+        CHECK_LT(d4, 900);
+
+        // Castling is written as the king capturing its rook
+        CHECK(Book::Probe(castling).IsKingCastle());
+        // Moves of no weight are never played
+        CHECK_EQ(Book::Moves(promotion).size(), 2);
+        CHECK_EQ(Book::Probe(promotion).PromotionPiece(), QUEEN);
+        CHECK_FALSE(Book::Probe(Board("8/8/8/8/8/8/8/K6k w - - 0 1")).IsDefined());
+
+        Book::Open("");
+        CHECK_FALSE(Book::Enabled());
+        std::filesystem::remove(path);
+    }
+}
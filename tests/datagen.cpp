@@ -0,0 +1,49 @@
+#include "board.hpp"
+#include "datagen.hpp"
+#include "packed.hpp"
+#include "third_party/doctest.h"
+#include "tt.hpp"
+#include "values.hpp"
+#include <cstdlib>
+#include <filesystem>
+
+TEST_SUITE("DATAGEN") {
+    TEST_CASE("GENERATE") {
+        const std::string path = std::filesystem::temp_directory_path() / "sunbird_datagen.pack";
+        std::filesystem::remove(path);
+        // The games search tables of their own, leaving the shared one as it was
+        TT::Init(1);
+        const Board board = Board();
+        const Move move   = Move(E2, E4, Move::DoublePawnPush);
+        TT::StoreEval(board.GetHash(), 1, 0, 10, TT::ProbeExact, move);
+
+        Datagen::Options options;
+        options.games   = 8;
+        options.threads = 2;
+        options.nodes   = 2000;
+        options.seed    = 1;
+        size_t reports  = 0;
+        const Datagen::Stats stats =
+            Datagen::Generate(path, options, [&reports](const Datagen::Stats &) { reports++; });
+        CHECK_EQ(TT::ProbeMove(board.GetHash()), move);
+        TT::Clean();
+
+        CHECK_EQ(stats.games, options.games);
+        CHECK_EQ(stats.threads, options.threads);
+        CHECK_EQ(reports, options.games);
+        Packed::Mapping mapping(path);
+        REQUIRE(mapping.IsOpen());
+        REQUIRE_EQ(mapping.Records().size(), stats.positions);
+        CHECK_GT(stats.positions, 0);
+        // Only quiet positions are kept, each with its score and the result of its game
+        size_t invalid = 0;
+        for (const Packed::Record &record : mapping.Records()) {
+            const Board position = Packed::Unpack(record);
+            invalid += !position.IsKingSafe(position.Turn());
+            invalid += record.result < -1 || record.result > 1;
+            invalid += std::abs(record.score) >= Values::KNOWN_WIN;
+        }
+        CHECK_EQ(invalid, 0);
+        std::filesystem::remove(path);
+    }
+}
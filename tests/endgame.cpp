@@ -0,0 +1,71 @@
+#include "board.hpp"
+#include "endgame.hpp"
+#include "evaluation.hpp"
+#include "third_party/doctest.h"
+#include "values.hpp"
+#include <cstdlib>
+
+TEST_SUITE("ENDGAME") {
+    TEST_CASE("KPK") {
+        const std::pair<std::string, bool> positions[] = {
+            // King in front of the pawn on the sixth row
+            {"4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", true},
+            {"4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", true},
+            {"8/8/8/8/4p3/4k3/8/4K3 b - - 0 1", true},
+            {"8/8/8/8/4p3/4k3/8/4K3 w - - 0 1", true},
+            // The king is outside the square of the pawn
+            {"8/8/8/P7/8/8/8/K6k b - - 0 1", true},
+            // Rook pawn with the king in front of it
+            {"k7/8/8/8/8/8/P7/K7 w - - 0 1", false},
+            // The pawn is captured
+            {"8/8/8/8/8/8/Pk6/7K b - - 0 1", false},
+            // Stalemate
+            {"4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", false},
+        };
+        for (const auto &[fen, win] : positions) {
+            const Board board = Board(fen);
+            const int eval    = Evaluation::Eval(board);
+            if (win) {
+                // Relative to the side to move, which may be the weak side
+                CHECK_GT(std::abs(eval), Values::KNOWN_WIN);
+            } else
+                CHECK_EQ(eval, 0);
+        }
+    }
+
+    TEST_CASE("DRAWN MATERIAL") {
+        for (const std::string fen : {
+                 "8/8/4k3/8/8/4K3/8/8 w - - 0 1",
+                 "8/8/4k3/8/8/3NK3/8/8 w - - 0 1",
+                 "8/8/4k3/8/8/3BK3/8/8 b - - 0 1",
+                 "8/8/4k3/8/8/2NNK3/8/8 w - - 0 1",
+                 "8/8/3nk3/8/8/4K3/8/3n4 w - - 0 1",
+             })
+            CHECK_EQ(Evaluation::Eval(Board(fen)), 0);
+    }
+
+    TEST_CASE("MATING MATERIAL") {
+        CHECK_GT(Evaluation::Eval(Board("8/8/8/4k3/8/8/8/R3K3 w - - 0 1")), Values::KNOWN_WIN);
+        CHECK_LT(Evaluation::Eval(Board("8/8/8/4k3/8/8/8/R3K3 b - - 0 1")), -Values::KNOWN_WIN);
+        CHECK_LT(Evaluation::Eval(Board("8/8/8/4k3/8/8/8/4Kq2 w - - 0 1")), -Values::KNOWN_WIN);
+
+        // With a light squared bishop, the king must be driven towards a8 or h1
+        const int right = Evaluation::Eval(Board("8/8/8/8/3K4/8/6k1/1BN5 w - - 0 1"));
+        const int wrong = Evaluation::Eval(Board("8/8/8/8/3K4/8/1k6/1BN5 w - - 0 1"));
+        CHECK_GT(wrong, Values::KNOWN_WIN);
+        CHECK_GT(right, wrong);
+    }
+
+    TEST_CASE("SCALE") {
+        const auto scale = [](const std::string &fen) {
+            return Endgame::Probe(Board(fen).GetPosition()).scale;
+        };
+        CHECK_EQ(scale("8/8/4k3/8/8/3bK3/8/R7 w - - 0 1")[WHITE], 4);
+        CHECK_EQ(scale("8/8/4k3/8/8/3bK3/8/R7 w - - 0 1")[BLACK], 0);
+        CHECK_EQ(scale("8/8/4k3/8/8/3NK3/8/2b5 w - - 0 1")[WHITE], 0);
+        CHECK_EQ(scale("8/8/4k3/8/8/3RK3/8/2n2n2 w - - 0 1")[WHITE], 14);
+        CHECK_EQ(scale("8/8/4k3/8/8/3QK3/8/2r5 w - - 0 1")[WHITE], Endgame::SCALE_NORMAL);
+        CHECK_EQ(scale("8/8/4k3/8/8/3RK3/5P2/2b5 w - - 0 1")[WHITE], Endgame::SCALE_NORMAL);
+        CHECK_EQ(scale(FEN_START)[WHITE], Endgame::SCALE_NORMAL);
+    }
+}
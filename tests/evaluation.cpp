@@ -0,0 +1,98 @@
+#include "board.hpp"
+#include "evaluation.hpp"
+#include "move_gen.hpp"
+#include "move_list.hpp"
+#include "third_party/doctest.h"
+#include "values.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace {
+// Collects every position reachable within the depth
+void Collect(Board &board, int depth, std::vector<Board> &boards) {
+    boards.push_back(board);
+    if (depth == 0) return;
+    for (const auto &move : GenerateMovesAll(board, board.Turn())) {
+        board.ApplyMove(move);
+        if (board.IsKingSafe(~board.Turn())) Collect(board, depth - 1, boards);
+        board.UndoMove(move);
+    }
+}
+} // namespace
+
+TEST_SUITE("EVALUATION") {
+    TEST_CASE("ISOLATED PAWNS") {
+        // The pawns of white are isolated, while those of black are not, and none are passed
+        const Board board = Board("4k3/1pp5/8/8/8/8/1P1P4/4K3 w - - 0 1");
+        const Score score = board.GetPieceSquare() + Values::Structure::IsolatedPawn * 2;
+        CHECK_EQ(Evaluation::Eval(board), score.Taper(std::min(24, board.GetPhase())));
+    }
+
+    TEST_CASE("PAWN STRUCTURE") {
+        const std::string fens[] = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "4k3/pp1p1pp1/1P1P2P1/P1p1P3/2P2p1p/1p3P1P/1P1p1P2/4K3 w - - 0 1",
+            "4k3/p1p1p1p1/p1p1p1p1/8/8/P1P1P1P1/P1P1P1P1/4K3 w - - 0 1",
+        };
+        std::vector<Board> boards;
+        for (const auto &fen : fens) {
+            Board board = Board(fen);
+            Collect(board, 3, boards);
+        }
+
+        for (const Board &board : boards)
+            CHECK_EQ(
+                Evaluation::Internal::EvalPawns(board), Evaluation::Internal::EvalPawnsLoop(board)
+            );
+    }
+
+    TEST_CASE("BATCH") {
+        const std::string fens[] = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "4k3/pp1p1pp1/1P1P2P1/P1p1P3/2P2p1p/1p3P1P/1P1p1P2/7K b - - 0 1",
+        };
+        std::vector<Board> boards;
+        for (const auto &fen : fens) {
+            Board board = Board(fen);
+            Collect(board, 3, boards);
+        }
+        std::vector<Position> positions;
+        for (const Board &board : boards)
+            positions.push_back(board.GetPosition());
+
+        std::vector<int> single(boards.size()), batch(boards.size()), threaded(boards.size());
+        for (size_t i = 0; i < boards.size(); i++)
+            single[i] = Evaluation::Eval(boards[i]);
+        Evaluation::EvalBatch(positions, batch, 1);
+        CHECK(batch == single);
+        // The threads of a batch are kept for the next, which may use fewer of them
+        for (const size_t threads : {4, 2, 4}) {
+            std::fill(threaded.begin(), threaded.end(), 0);
+            Evaluation::EvalBatch(positions, threaded, threads);
+            CHECK(threaded == single);
+        }
+    }
+
+    TEST_CASE("EVAL CACHE") {
+        Board board = Board("r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4");
+        std::vector<Board> boards;
+        Collect(board, 2, boards);
+
+        std::vector<int> evals;
+        Evaluation::ResetCacheStats();
+        for (const Board &b : boards)
+            evals.push_back(Evaluation::Eval(b));
+        const size_t hits = Evaluation::GetCacheStats().evalHits;
+
+        // Apart from positions sharing a slot, each is found in the cache on the second pass
+        for (size_t i = 0; i < boards.size(); i++)
+            CHECK_EQ(Evaluation::Eval(boards[i]), evals[i]);
+        const Evaluation::CacheStats stats = Evaluation::GetCacheStats();
+        CHECK_EQ(stats.evalProbes, 2 * boards.size());
+        CHECK_GE(stats.evalHits - hits, boards.size() * 9 / 10);
+    }
+}
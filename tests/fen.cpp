@@ -0,0 +1,118 @@
+#include "board.hpp"
+#include "fen.hpp"
+#include "third_party/doctest.h"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+void CheckPosition(const Position &position, const Position &expected) {
+    CHECK_EQ(position.hash, expected.hash);
+    CHECK_EQ(position.pawn_hash, expected.pawn_hash);
+    CHECK_EQ(position.material_hash, expected.material_hash);
+    CHECK_EQ(position.pieces, expected.pieces);
+    CHECK_EQ(position.colors, expected.colors);
+    CHECK_EQ(position.squares, expected.squares);
+    CHECK_EQ(position.turn, expected.turn);
+    CHECK_EQ(position.ep, expected.ep);
+    CHECK_EQ(position.castling, expected.castling);
+    CHECK_EQ(position.halfmove, expected.halfmove);
+    CHECK_EQ(position.psq, expected.psq);
+    CHECK_EQ(position.phase, expected.phase);
+}
+
+const std::string FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "rnbqkbnr/ppp1pppp/8/8/3pP3/5NP1/PPPP1P1P/RNBQKB1R b KQkq e3 0 3",
+    "r1bq1rk1/pp2bppp/2n2n2/3p4/3P4/2NB1N2/PP3PPP/R1BQ1RK1 b - - 12 10",
+};
+} // namespace
+
+TEST_SUITE("FEN") {
+    TEST_CASE("PARSE") {
+        // The position reached by moves equals that of its string
+        const Board played = Board(FEN_START, "g1f3 d7d5 g2g3 d5d4 e2e4");
+        Position position;
+        const FEN::Result result = FEN::Parse(FENS[3], position);
+        CHECK_EQ(result.error, FEN::Error::None);
+        CHECK_EQ(result.offset, FENS[3].size());
+        CHECK_EQ(result.fullMove, 3);
+        CheckPosition(position, played.GetPosition());
+
+        // The move counters may be left out, as in EPD, whose operations follow the fields
+        const std::string epd = "r1bq1rk1/pp2bppp/2n2n2/3p4/3P4/2NB1N2/PP3PPP/R1BQ1RK1 b - - "
+                                "bm a7a6; id \"12 10\";";
+        Position fromEPD;
+        const FEN::Result epdResult = FEN::Parse(epd, fromEPD);
+        CHECK_EQ(epdResult.error, FEN::Error::None);
+        CHECK_EQ(epd.substr(epdResult.offset), " bm a7a6; id \"12 10\";");
+        CHECK_EQ(epdResult.fullMove, 1);
+        CHECK_EQ(fromEPD.hash, Board(FENS[4]).GetHash());
+        CHECK_EQ(fromEPD.halfmove, 0);
+        CHECK_EQ(Board(FENS[4]).FullMoveNumber(), 10);
+    }
+
+    TEST_CASE("ERRORS") {
+        const std::pair<std::string, FEN::Error> invalid[] = {
+            {"", FEN::Error::Placement},
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1", FEN::Error::Placement},
+            {"rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", FEN::Error::Placement},
+            {"rnbqkbnr/pppppppp/8/8/8/7/PPPPPPPP/RNBQKBNR w KQkq - 0 1", FEN::Error::Placement},
+            {"rnbqkbnr/ppppxppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", FEN::Error::Placement},
+            // Each side needs a single king, and pawns cannot stand on the first or last row
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQ1BNR w kq - 0 1", FEN::Error::Placement},
+            {"rnbqkbnr/pppppppp/8/8/8/4k3/PPPPPPPP/RNBQKBNR w KQkq - 0 1", FEN::Error::Placement},
+            {"8/8/8/8/8/8/8/8 w - - 0 1", FEN::Error::Placement},
+            {"rnbqkbnP/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQq - 0 1", FEN::Error::Placement},
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/pNBQKBNR w Kkq - 0 1", FEN::Error::Placement},
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR", FEN::Error::Turn},
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1", FEN::Error::Turn},
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQxq - 0 1", FEN::Error::Castling},
+            // Castling rights need the king and the rook on their squares from the start
+            {"4k3/8/8/8/8/8/8/4K3 w KQkq - 0 1", FEN::Error::Castling},
+            {"r3k2r/8/8/8/8/8/8/R4K1R w K - 0 1", FEN::Error::Castling},
+            {"r3k2r/8/8/8/8/8/8/R3K3 w K - 0 1", FEN::Error::Castling},
+            {"4k2r/8/8/8/8/8/8/R3K2R b KQq - 0 1", FEN::Error::Castling},
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq", FEN::Error::EnPassant},
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1", FEN::Error::EnPassant},
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0x 1", FEN::Error::Counters},
+        };
+        Position position;
+        for (const auto &[fen, error] : invalid) {
+            const FEN::Result result = FEN::Parse(fen, position);
+            CHECK_EQ(result.error, error);
+            CHECK_LE(result.offset, fen.size());
+        }
+    }
+
+    TEST_CASE("LOAD") {
+        const std::string path = std::filesystem::temp_directory_path() / "sunbird_test.epd";
+        const size_t COUNT     = 200000;
+        {
+            std::ofstream file(path, std::ios::binary);
+            for (size_t i = 0; i < COUNT; i++) {
+                file << FENS[i % std::size(FENS)] << ((i % 7 == 0) ? "\r\n" : "\n");
+                // Empty lines are skipped, while invalid ones are counted
+                if (i % 1000 == 0) file << "\n";
+                if (i % 5000 == 0) file << "not a position\n";
+            }
+            // The last line need not end in a line break
+            file << FENS[0];
+        }
+
+        const FEN::Batch single   = FEN::Load(path, 1);
+        const FEN::Batch threaded = FEN::Load(path, 4);
+        for (const FEN::Batch *batch : {&single, &threaded}) {
+            REQUIRE_EQ(batch->positions.size(), COUNT + 1);
+            CHECK_EQ(batch->errors, COUNT / 5000);
+            for (size_t i = 0; i < batch->positions.size(); i++)
+                if (batch->positions[i].hash != Board(FENS[i % std::size(FENS)]).GetHash()) {
+                    FAIL("position ", i, " differs");
+                    break;
+                }
+        }
+        std::filesystem::remove(path);
+        CHECK(FEN::Load(path).positions.empty());
+    }
+}
@@ -117,3 +117,9 @@ TEST_CASE("BITBOARD::QueenAttacks") {
     CHECK_EQ(ATTACKS[QUEEN][A8], 0xfe03050911214181);
     CHECK_EQ(ATTACKS[QUEEN][H8], 0x7fc0a09088848281);
 }
+
+TEST_CASE("BITBOARD::PawnIsolation") {
+    CHECK_EQ(PawnIsolationMask(A2), 0x202020202020202);
+    CHECK_EQ(PawnIsolationMask(D4), 0x1414141414141414);
+    CHECK_EQ(PawnIsolationMask(H7), 0x4040404040404040);
+}
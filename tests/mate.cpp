@@ -0,0 +1,73 @@
+#include "board.hpp"
+#include "mate.hpp"
+#include "move_gen.hpp"
+#include "move_list.hpp"
+#include "search.hpp"
+#include "third_party/doctest.h"
+#include "tt.hpp"
+
+namespace {
+// Returns whether the line ends in checkmate
+bool Mates(Board board, const std::vector<Move> &pv) {
+    for (const Move move : pv)
+        board.ApplyMove(move);
+    if (board.IsKingSafe(board.Turn())) return false;
+    for (const Move move : GenerateMovesAll(board, board.Turn())) {
+        board.ApplyMove(move);
+        const bool legal = board.IsKingSafe(~board.Turn());
+        board.UndoMove(move);
+        if (legal) return false;
+    }
+    return true;
+}
+} // namespace
+
+TEST_SUITE("MATE") {
+    TEST_CASE("SOLVE") {
+        const std::tuple<std::string, size_t, std::string> positions[] = {
+            {"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 1, "a1a8"},
+            {"kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1", 2, "a1a6"},
+            {"r1b1kb1r/pppp1ppp/5q2/4n3/3KP3/2N3PN/PPP4P/R1BQ1B1R b kq - 0 1", 3, "f8c5"},
+        };
+        for (const auto &[fen, moves, first] : positions) {
+            Board board               = Board(fen);
+            const Mate::Result result = Mate::Solve(board, 5);
+            CHECK_EQ(result.moves, moves);
+            REQUIRE_FALSE(result.pv.empty());
+            CHECK_EQ(result.pv[0].Export(), first);
+            CHECK_EQ(result.pv.size(), 2 * moves - 1);
+            CHECK(Mates(board, result.pv));
+            CHECK_EQ(board.GetHash(), Board(fen).GetHash());
+        }
+    }
+
+    TEST_CASE("NO MATE") {
+        // The mate takes two moves
+        Board board = Board("kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1");
+        CHECK_EQ(Mate::Solve(board, 1).moves, 0);
+        // Stalemate is no mate
+        board = Board("k7/8/1Q6/8/8/8/8/7K w - - 0 1");
+        CHECK_EQ(Mate::Solve(board, 1).moves, 0);
+        board = Board();
+        CHECK_EQ(Mate::Solve(board, 2).moves, 0);
+    }
+
+    TEST_CASE("SHARE") {
+        // The solver ends once it has used its share, leaving the rest of the limit to the search
+        TT::Init(1);
+        Board board             = Board();
+        const size_t priorMoves = board.MoveCount();
+        Search::SearchLimit limit;
+        limit.Start(Search::TimeManager::UNLIMITED, priorMoves + 20000);
+        const Mate::Result result = Mate::Solve(board, 3, &limit, SIZE_MAX, priorMoves + 10000);
+        CHECK_EQ(result.moves, 0);
+        CHECK_LT(result.nodes, 11000);
+        CHECK_FALSE(limit.Stopped());
+
+        const PV pv = Search::GetBestMove(board, Search::Limits(), limit);
+        CHECK_FALSE(pv.empty());
+        CHECK(limit.Stopped());
+        CHECK_LT(board.MoveCount() - priorMoves, 21000);
+        TT::Clean();
+    }
+}
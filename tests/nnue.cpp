@@ -0,0 +1,130 @@
+#include "board.hpp"
+#include "evaluation.hpp"
+#include "move_gen.hpp"
+#include "move_list.hpp"
+#include "nnue.hpp"
+#include "third_party/doctest.h"
+#include "values.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+// Compares the incrementally updated hidden layers to those computed from scratch, at every
+// position reachable within the depth
+void Check(Board &board, int depth) {
+    NNUE::Accumulator refreshed;
+    NNUE::Refresh(refreshed, board.GetPosition());
+    const NNUE::Accumulator &accumulator = board.GetAccumulator();
+    CHECK(accumulator.values == refreshed.values);
+    CHECK_EQ(NNUE::Evaluate(accumulator, board.Turn()), NNUE::Evaluate(refreshed, board.Turn()));
+    CHECK_EQ(
+        NNUE::Evaluate(accumulator, board.Turn()),
+        NNUE::Internal::EvaluateScalar(accumulator, board.Turn())
+    );
+    if (depth == 0) return;
+
+    for (const auto &move : GenerateMovesAll(board, board.Turn())) {
+        board.ApplyMove(move);
+        if (board.IsKingSafe(~board.Turn())) Check(board, depth - 1);
+        board.UndoMove(move);
+    }
+}
+} // namespace
+
+TEST_SUITE("NNUE") {
+    TEST_CASE("INCREMENTAL") {
+        NNUE::Internal::Randomize(1);
+        for (const std::string fen : {
+                 "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                 "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                 "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                 "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+             }) {
+            Board board = Board(fen);
+            Check(board, 2);
+        }
+        NNUE::Disable();
+    }
+
+    TEST_CASE("COPY") {
+        // A copy keeps the hidden layers of its ply, and computes those of the plies before it,
+        // as well as those after it, as the original does
+        NNUE::Internal::Randomize(1);
+        const Move moves[] = {
+            Move(E2, E4, Move::DoublePawnPush), Move(E7, E5, Move::DoublePawnPush),
+            Move(G1, F3, Move::Quiet), Move(B8, C6, Move::Quiet)
+        };
+        Board board = Board();
+        for (const Move move : moves)
+            board.ApplyMove(move);
+        Board copy = board;
+        Check(copy, 2);
+        for (auto move = std::rbegin(moves); move != std::rend(moves); move++) {
+            copy.UndoMove(*move);
+            Check(copy, 1);
+        }
+        copy = board;
+        Check(copy, 1);
+        NNUE::Disable();
+    }
+
+    TEST_CASE("LOAD") {
+        const std::string path = std::filesystem::temp_directory_path() / "sunbird_test.nnue";
+        const Board board =
+            Board("r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 4 4");
+        NNUE::Internal::Randomize(2);
+        const int expected = Evaluation::Eval(board);
+        CHECK_EQ(expected, NNUE::Evaluate(board.GetAccumulator(), board.Turn()));
+        REQUIRE(NNUE::Save(path));
+
+        NNUE::Internal::Randomize(3);
+        CHECK_NE(Evaluation::Eval(board), expected);
+        REQUIRE(NNUE::Load(path));
+        CHECK_EQ(Evaluation::Eval(board), expected);
+        std::filesystem::remove(path);
+
+        // A missing file keeps the current network
+        CHECK_FALSE(NNUE::Load(path));
+        CHECK(NNUE::Enabled());
+        NNUE::Disable();
+        CHECK_FALSE(NNUE::Enabled());
+        CHECK_EQ(NNUE::Id(), 0);
+    }
+
+    TEST_CASE("OUTPUT BOUNDS") {
+        // Saturated activations and weights, whose output overflows 32 bits once scaled
+        const std::string path = std::filesystem::temp_directory_path() / "sunbird_test.nnue";
+        const Board board      = Board();
+        for (const int sign : {1, -1}) {
+            {
+                std::ofstream file(path, std::ios::binary);
+                const auto write = [&file](const auto *data, size_t count) {
+                    file.write(reinterpret_cast<const char *>(data), count * sizeof(*data));
+                };
+                // The magic number, "SBNN", and the hidden size
+                const uint32_t header[] = {0x4E4E4253, NNUE::HIDDEN_SIZE};
+                const std::vector<int16_t> inputBias(NNUE::HIDDEN_SIZE, 127);
+                const std::vector<int16_t> inputWeights(NNUE::INPUT_SIZE * NNUE::HIDDEN_SIZE, 0);
+                const std::vector<int8_t> outputWeights(COLOR_COUNT * NNUE::HIDDEN_SIZE, 127);
+                const int32_t outputBias = sign * (INT32_MAX / 2);
+                write(header, 2);
+                write(inputBias.data(), inputBias.size());
+                write(inputWeights.data(), inputWeights.size());
+                write(outputWeights.data(), outputWeights.size());
+                write(&outputBias, 1);
+            }
+            REQUIRE(NNUE::Load(path));
+            NNUE::Accumulator accumulator;
+            NNUE::Refresh(accumulator, board.GetPosition());
+            const int eval = NNUE::Evaluate(accumulator, board.Turn());
+            CHECK_EQ(eval > 0, sign > 0);
+            CHECK_LT(std::abs(eval), Values::KNOWN_WIN);
+            CHECK_EQ(NNUE::Internal::EvaluateScalar(accumulator, board.Turn()), eval);
+        }
+        std::filesystem::remove(path);
+        NNUE::Disable();
+    }
+}
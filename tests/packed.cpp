@@ -0,0 +1,106 @@
+#include "board.hpp"
+#include "fen.hpp"
+#include "packed.hpp"
+#include "third_party/doctest.h"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+const std::string FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/8/8/8/8/8/8/R3K2R b Kq - 7 41",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "rnbqkbnr/ppp1pppp/8/8/3pP3/5NP1/PPPP1P1P/RNBQKB1R b KQkq e3 0 3",
+    "8/P6k/8/8/8/8/8/K7 w - - 99 300",
+};
+
+void CheckBoard(const Board &board, const Board &expected) {
+    const Position &position = board.GetPosition();
+    CHECK_EQ(position.hash, expected.GetHash());
+    CHECK_EQ(position.pawn_hash, expected.GetPawnHash());
+    CHECK_EQ(position.material_hash, expected.GetMaterialHash());
+    CHECK_EQ(position.squares, expected.GetPosition().squares);
+    CHECK_EQ(position.psq, expected.GetPieceSquare());
+    CHECK_EQ(position.phase, expected.GetPhase());
+    CHECK_EQ(board.Turn(), expected.Turn());
+    CHECK_EQ(board.EP(), expected.EP());
+    CHECK_EQ(board.GetCastling(WHITE), expected.GetCastling(WHITE));
+    CHECK_EQ(board.GetCastling(BLACK), expected.GetCastling(BLACK));
+    CHECK_EQ(board.HalfMoveClock(), expected.HalfMoveClock());
+    CHECK_EQ(board.FullMoveNumber(), expected.FullMoveNumber());
+}
+} // namespace
+
+TEST_SUITE("PACKED") {
+    TEST_CASE("PACK") {
+        for (const std::string &fen : FENS) {
+            const Board board           = Board(fen);
+            const Packed::Record record = Packed::Pack(board, 25, -1);
+            CheckBoard(Packed::Unpack(record), board);
+            CHECK_EQ(record.score, 25);
+            CHECK_EQ(record.result, -1);
+        }
+        // Scores beyond those of a record are clamped
+        CHECK_EQ(Packed::Pack(Board(), 90000).score, INT16_MAX);
+        CHECK_EQ(Packed::Pack(Board(), -90000).score, -INT16_MAX);
+        CHECK_EQ(Packed::Pack(Board()).score, Packed::NO_SCORE);
+        CHECK_EQ(Packed::Pack(Board()).result, Packed::NO_RESULT);
+    }
+
+    TEST_CASE("FILE") {
+        const std::string path = std::filesystem::temp_directory_path() / "sunbird_test.pack";
+        const std::string fens = std::filesystem::temp_directory_path() / "sunbird_test.epd";
+        const size_t COUNT     = 200000;
+        {
+            Packed::Writer writer(path);
+            REQUIRE(writer.IsOpen());
+            std::ofstream text(fens);
+            for (size_t i = 0; i < COUNT; i++) {
+                const std::string &fen = FENS[i % std::size(FENS)];
+                writer.Write(Packed::Pack(Board(fen), i % 1000, 0));
+                text << fen << '\n';
+            }
+        }
+        {
+            // A partial record, as of a file being written, is left out
+            Packed::Writer writer(path, true);
+            writer.Write(Packed::Pack(Board(FENS[0])));
+            writer.Flush();
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        }
+        Packed::Mapping mapping(path);
+        REQUIRE(mapping.IsOpen());
+        REQUIRE_EQ(mapping.Records().size(), COUNT);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < COUNT; i++) {
+            const Packed::Record &record = mapping.Records()[i];
+            const Board board            = Board(FENS[i % std::size(FENS)]);
+            mismatches += Packed::Unpack(record).GetHash() != board.GetHash();
+            mismatches += record.score != static_cast<int>(i % 1000);
+        }
+        CHECK_EQ(mismatches, 0);
+
+        // Streaming and parsing the text give the same positions as mapping
+        uint64_t mapped = 0, streamed = 0, parsed = 0;
+        for (const Packed::Record &record : mapping.Records())
+            mapped ^= Packed::Unpack(record).GetHash();
+        Packed::Reader reader(path);
+        REQUIRE(reader.IsOpen());
+        Packed::Record record;
+        size_t count = 0;
+        for (; reader.Next(record); count++)
+            streamed ^= Packed::Unpack(record).GetHash();
+        const FEN::Batch batch = FEN::Load(fens, 1);
+        for (const Position &position : batch.positions)
+            parsed ^= position.hash;
+        CHECK_EQ(count, COUNT);
+        CHECK_EQ(streamed, mapped);
+        CHECK_EQ(parsed, mapped);
+
+        std::filesystem::remove(path);
+        std::filesystem::remove(fens);
+        CHECK_FALSE(Packed::Mapping(path).IsOpen());
+        CHECK_FALSE(Packed::Reader(path).IsOpen());
+    }
+}
@@ -0,0 +1,50 @@
+#include "board.hpp"
+#include "fen.hpp"
+#include "position_command.hpp"
+#include "third_party/doctest.h"
+#include <string>
+#include <string_view>
+
+TEST_SUITE("POSITION COMMAND") {
+    TEST_CASE("TOKENS") {
+        // Tokens are separated by any whitespace, as GUIs may send tabs or line endings
+        std::string_view view = "  startpos\tmoves e2e4 \t e7e5\r\n";
+        CHECK_EQ(PositionCommand::NextToken(view), "startpos");
+        CHECK_EQ(PositionCommand::NextToken(view), "moves");
+        CHECK_EQ(PositionCommand::NextToken(view), "e2e4");
+        CHECK_EQ(PositionCommand::NextToken(view), "e7e5");
+        CHECK_EQ(PositionCommand::NextToken(view), "");
+        CHECK(view.empty());
+    }
+
+    TEST_CASE("EXTEND") {
+        // A command extending the last gives the same board as one applied from scratch
+        const std::string commands[] = {
+            " startpos moves e2e4",
+            " startpos moves e2e4 e7e5\tg1f3",
+            " startpos  moves e2e4 e7e5 g1f3 b8c6 f1b5\r",
+            " startpos moves e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1",
+            " startpos moves d2d4",
+            " fen 4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1 moves e1g1 e8d7",
+            " fen 4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1 moves e1g1 e8d7 a1a7",
+        };
+        Board board;
+        PositionCommand::Last last;
+        for (const std::string &command : commands) {
+            REQUIRE_EQ(PositionCommand::Apply(board, command, last), FEN::Error::None);
+            Board rebuilt;
+            PositionCommand::Last none;
+            REQUIRE_EQ(PositionCommand::Apply(rebuilt, command, none), FEN::Error::None);
+            CHECK_EQ(board.GetHash(), rebuilt.GetHash());
+            CHECK_EQ(board.Ply(), rebuilt.Ply());
+            CHECK_EQ(board.HalfMoveClock(), rebuilt.HalfMoveClock());
+            CHECK_EQ(last.moves, none.moves);
+        }
+
+        // An invalid position keeps the prior one
+        const uint64_t hash    = board.GetHash();
+        const FEN::Error error = PositionCommand::Apply(board, " fen 8/8/8 w - - 0 1", last);
+        CHECK_EQ(error, FEN::Error::Placement);
+        CHECK_EQ(board.GetHash(), hash);
+    }
+}
@@ -0,0 +1,39 @@
+#include "score.hpp"
+#include "third_party/doctest.h"
+#include <initializer_list>
+
+TEST_SUITE("SCORE") {
+    TEST_CASE("PACKING") {
+        for (const int mg : {0, 1, -1, 500, -500, 32767, -32768})
+            for (const int eg : {0, 1, -1, 300, -300, 32767, -32768}) {
+                const Score score = Score(mg, eg);
+                CHECK_EQ(score.MG(), mg);
+                CHECK_EQ(score.EG(), eg);
+            }
+        // Constant evaluation rejects any overflow of signed integers at the ends of the ranges
+        constexpr Score LOW  = Score(-32768, -32768);
+        constexpr Score HIGH = Score(32767, 32767);
+        static_assert(LOW.MG() == -32768 && LOW.EG() == -32768);
+        static_assert(HIGH.MG() == 32767 && HIGH.EG() == 32767);
+        static_assert(LOW - LOW == Score() && LOW + HIGH == Score(-1, -1));
+        static_assert(-HIGH == Score(-32767, -32767));
+        static_assert(Score(-16384, -16384) * 2 == LOW);
+    }
+    TEST_CASE("ARITHMETIC") {
+        const Score a = Score(100, -20);
+        const Score b = Score(-30, 50);
+        CHECK_EQ((a + b).MG(), 70);
+        CHECK_EQ((a + b).EG(), 30);
+        CHECK_EQ((a - b).MG(), 130);
+        CHECK_EQ((a - b).EG(), -70);
+        CHECK_EQ((b * -3).MG(), 90);
+        CHECK_EQ((b * -3).EG(), -150);
+        CHECK_EQ(-a, Score(-100, 20));
+    }
+    TEST_CASE("TAPER") {
+        const Score score = Score(240, -48);
+        CHECK_EQ(score.Taper(24), 240);
+        CHECK_EQ(score.Taper(0), -48);
+        CHECK_EQ(score.Taper(12), 96);
+    }
+}
@@ -0,0 +1,170 @@
+#include "board.hpp"
+#include "pv.hpp"
+#include "root_moves.hpp"
+#include "search_limit.hpp"
+#include "search.hpp"
+#include "third_party/doctest.h"
+#include "tt.hpp"
+#include "values.hpp"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("SEARCH") {
+    TEST_CASE("FIFTY MOVES") {
+        TT::Init(1);
+        const int INF = Values::INF;
+        // A mate on the hundredth half move is a mate rather than a draw, though pseudo-legal
+        // moves remain
+        Board board = Board("R5k1/5ppp/8/8/8/8/8/6K1 b - - 100 80");
+        CHECK_EQ(Search::Internal::Negamax(board, -INF, INF, 3, 4, PV()), Values::MatedIn(4));
+        board = Board("6k1/5ppp/8/8/8/8/8/R5K1 w - - 99 80");
+        CHECK_EQ(Search::Internal::Negamax(board, -INF, INF, 3, 0, PV()), Values::MateIn(1));
+        // Without a mate, the game is drawn
+        TT::Clear();
+        board = Board("6k1/5ppp/8/8/8/8/8/R5K1 b - - 100 80");
+        CHECK_EQ(Search::Internal::Negamax(board, -INF, INF, 3, 0, PV()), 0);
+        TT::Clean();
+    }
+
+    TEST_CASE("MATE DISTANCE") {
+        // Mates are scored by their distance from the root, also when found again in the table
+        TT::Init(1);
+        const int INF = Values::INF;
+        Board board   = Board("kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1");
+        CHECK_EQ(Search::Internal::Negamax(board, -INF, INF, 7, 0, PV()), Values::MateIn(3));
+        CHECK_EQ(Search::Internal::Negamax(board, -INF, INF, 7, 2, PV()), Values::MateIn(5));
+        CHECK_EQ(Search::Internal::Negamax(board, -INF, INF, 7, 0, PV()), Values::MateIn(3));
+
+        // Pseudo-legal moves remain, though none of them is legal
+        board = Board("R5k1/5ppp/8/8/8/8/8/6K1 b - - 0 1");
+        CHECK_EQ(Search::Internal::Negamax(board, -INF, INF, 3, 4, PV()), Values::MatedIn(4));
+        TT::Clean();
+    }
+
+    TEST_CASE("MULTIPV") {
+        // The queen is left hanging, such that taking it is best by far
+        Board board = Board("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1");
+        Search::Limits limits;
+        limits.depth = 5;
+        TT::Init(1);
+        Search::SearchLimit single;
+        const PV pv = Search::GetBestMove(board, limits, single);
+        TT::Clear();
+        Search::SearchLimit limit;
+        const std::vector<RootMove> lines = Search::GetBestLines(board, limits, limit, 4);
+        TT::Clean();
+
+        REQUIRE_FALSE(pv.empty());
+        REQUIRE_EQ(lines.size(), 4);
+        CHECK(lines[0].move == pv[0]);
+        CHECK_EQ(lines[0].move.Export(), "d2d5");
+        for (size_t i = 0; i < lines.size(); i++) {
+            REQUIRE_FALSE(lines[i].pv.empty());
+            CHECK(lines[i].pv[0] == lines[i].move);
+            if (i > 0) CHECK_GE(lines[i - 1].score, lines[i].score);
+            for (size_t j = 0; j < i; j++)
+                CHECK_FALSE(lines[j].move == lines[i].move);
+        }
+    }
+
+    TEST_CASE("ROOT MOVES") {
+        // The king has three moves, kept in the order generated until scored
+        Board board = Board("7k/8/8/8/8/8/8/K7 w - - 0 1");
+        RootMoves rootMoves(board);
+        REQUIRE_EQ(rootMoves.size(), 3);
+        const Move a = rootMoves[0].move, b = rootMoves[1].move, c = rootMoves[2].move;
+        const auto order = [&rootMoves](Move first, Move second, Move third) {
+            return rootMoves[0].move == first && rootMoves[1].move == second &&
+                   rootMoves[2].move == third;
+        };
+
+        // Moves are ordered by the scores of the iteration, and equal scores by their nodes
+        rootMoves[0].score = 10;
+        rootMoves[0].nodes = 5;
+        rootMoves[1].score = 20;
+        rootMoves[1].nodes = 1;
+        rootMoves[2].score = 10;
+        rootMoves[2].nodes = 9;
+        rootMoves.next_iteration();
+        CHECK(order(b, c, a));
+        CHECK_EQ(rootMoves[0].previousScore, 20);
+        CHECK_EQ(rootMoves.nodes(), 15);
+        CHECK_EQ(rootMoves.best_share(), doctest::Approx(1.0 / 15));
+        // Equal scores and nodes keep their order
+        rootMoves[2].nodes = 9;
+        rootMoves.next_iteration();
+        CHECK(order(b, c, a));
+
+        // Sorting by score is stable, and limited to the range
+        rootMoves[0].score = -Values::INF;
+        rootMoves[1].score = 30;
+        rootMoves[2].score = -Values::INF;
+        rootMoves.sort(1, 3);
+        CHECK(order(b, c, a));
+        rootMoves.sort(0, 3);
+        CHECK(order(c, b, a));
+
+        // Removing moves keeps the order of the rest
+        rootMoves.remove_if([&](const RootMove &rm) { return rm.move == b; });
+        REQUIRE_EQ(rootMoves.size(), 2);
+        CHECK(rootMoves[0].move == c);
+        CHECK(rootMoves[1].move == a);
+        rootMoves.remove_if([](const RootMove &) { return true; });
+        CHECK(rootMoves.empty());
+    }
+
+    TEST_CASE("STOP") {
+        // A search stopped from another thread returns at once, with a legal move of the last
+        // finished iteration
+        TT::Init(1);
+        Board board = Board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+        Search::Limits limits;
+        limits.infinite = true;
+        Search::SearchLimit limit;
+        RootMove best;
+        std::thread search([&] { best = Search::GetBestRootMove(board, limits, limit); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        const auto stop = std::chrono::steady_clock::now();
+        limit.Stop();
+        search.join();
+        const auto returned = std::chrono::steady_clock::now();
+        TT::Clean();
+
+        CHECK(limit.Stopped());
+        CHECK_LT(returned - stop, std::chrono::milliseconds(500));
+        const RootMoves legal(board);
+        CHECK(std::any_of(legal.begin(), legal.end(), [&](const RootMove &rm) {
+            return rm.move == best.move;
+        }));
+        // The line is of the finished iteration, and starts with the move
+        REQUIRE_FALSE(best.pv.empty());
+        CHECK(best.pv[0] == best.move);
+        CHECK_NE(best.score, -Values::INF);
+    }
+
+    TEST_CASE("UCI SCORE") {
+        CHECK_EQ(Search::Internal::UciScore(25), "cp 25");
+        CHECK_EQ(Search::Internal::UciScore(Values::MateIn(3)), "mate 2");
+        CHECK_EQ(Search::Internal::UciScore(Values::MatedIn(4)), "mate -2");
+        // Tablebase wins are reported below the mates, preferring shorter ones
+        CHECK_EQ(Search::Internal::UciScore(Values::TB_WIN - 3), "cp 19997");
+        CHECK_EQ(Search::Internal::UciScore(-Values::TB_WIN + 4), "cp -19996");
+    }
+
+    TEST_CASE("PONDER HIT") {
+        // Whichever of Start and the ponder hit comes first, the clock starts with the time
+        for (int i = 0; i < 100; i++) {
+            Search::SearchLimit limit(true);
+            std::thread hit([&limit] { limit.PonderHit(); });
+            limit.Start(0);
+            hit.join();
+            CHECK_FALSE(limit.Pondering());
+            // Without a time, the clock stops the search when first read
+            for (size_t polls = 0; polls < 4096; polls++)
+                if (limit.Reached(0)) break;
+            CHECK(limit.Stopped());
+        }
+    }
+}
@@ -0,0 +1,219 @@
+#include "bit.hpp"
+#include "board.hpp"
+#include "endgame.hpp"
+#include "move_gen.hpp"
+#include "move_list.hpp"
+#include "search.hpp"
+#include "tablebase.hpp"
+#include "third_party/doctest.h"
+#include "tt.hpp"
+#include "utilities.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+const std::string DIRECTORY = std::filesystem::temp_directory_path() / "sunbird_test_tb";
+
+// The endings of three pieces are generated once, for all tests
+void Require() {
+    static size_t reports         = 0;
+    static const size_t generated = Tablebase::Generate(
+        DIRECTORY, 3, 0, [](std::string_view, bool success) { reports += success; }
+    );
+    REQUIRE_EQ(generated, 5);
+    REQUIRE_EQ(reports, 5);
+    if (Tablebase::MaxPieces() == 0) Tablebase::Init(DIRECTORY);
+    REQUIRE_EQ(Tablebase::MaxPieces(), 3);
+}
+
+// Returns a board of a pawn and king each, without castling rights or an en passant square
+Board Place(Color turn, Square whiteKing, Square whitePawn, Square blackKing, Square blackPawn) {
+    Position position;
+    PlacePiece(position, WHITE, KING, whiteKing);
+    PlacePiece(position, WHITE, PAWN, whitePawn);
+    PlacePiece(position, BLACK, KING, blackKing);
+    PlacePiece(position, BLACK, PAWN, blackPawn);
+    SetState(position, turn, {Castling::None, Castling::None}, SQUARE_NONE);
+    return Board(position);
+}
+
+// Returns the result of the position once its en passant square is removed
+int Declined(const Board &board) {
+    const auto king = [&board](Color color) { return lsb(board.Pieces(color, KING)); };
+    const auto pawn = [&board](Color color) { return lsb(board.Pieces(color, PAWN)); };
+    return static_cast<int>(Tablebase::Probe(
+        Place(board.Turn(), king(WHITE), pawn(WHITE), king(BLACK), pawn(BLACK))
+    ));
+}
+
+// Returns the result for the side to move by the best of its moves, from the tables
+// A double push gives the other side the choice of capturing en passant, or of declining for the
+// same position without the en passant square, counting those where the capture is better
+int BestMove(Board &board, size_t &changed) {
+    const Color us = board.Turn();
+    int best       = -1;
+    bool legal     = false;
+    for (const Move move : GenerateMovesAll(board, us)) {
+        board.ApplyMove(move);
+        if (board.IsKingSafe(us)) {
+            legal     = true;
+            int reply = static_cast<int>(Tablebase::Probe(board));
+            if (move.IsDouble()) {
+                reply              = Declined(board);
+                const int declined = reply;
+                for (const Move capture : GenerateMovesAll(board, ~us)) {
+                    if (!capture.IsEnPassant()) continue;
+                    board.ApplyMove(capture);
+                    if (board.IsKingSafe(~us))
+                        reply = std::max(reply, -static_cast<int>(Tablebase::Probe(board)));
+                    board.UndoMove(capture);
+                }
+                changed += reply != declined;
+            }
+            best = std::max(best, -reply);
+        }
+        board.UndoMove(move);
+    }
+    if (!legal) return board.IsKingSafe(us) ? 0 : -1;
+    return best;
+}
+} // namespace
+
+TEST_SUITE("TABLEBASE") {
+    TEST_CASE("ENDINGS") {
+        const auto endings = Tablebase::Internal::Endings(4);
+        CHECK_EQ(endings.size(), 35);
+        // Each ending comes after those which captures and promotions lead to
+        const auto position = [&](const std::string &name) {
+            return std::find(endings.begin(), endings.end(), name) - endings.begin();
+        };
+        CHECK_LT(position("KQvK"), position("KPvK"));
+        CHECK_LT(position("KPvK"), position("KRvKN"));
+        CHECK_LT(position("KQvKP"), position("KPvKP"));
+        CHECK_LT(position("KQPvK"), position("KPPvK"));
+    }
+
+    TEST_CASE("KPK") {
+        Require();
+        // Agrees with the bitbase of the evaluation, at every position of the pawn and kings
+        size_t probed = 0;
+        for (const Color turn : {WHITE, BLACK}) {
+            Position empty;
+            SetState(empty, turn, {Castling::None, Castling::None}, SQUARE_NONE);
+            Board board = Board(empty);
+            for (Square pawn = A2; pawn <= H7; pawn = static_cast<Square>(pawn + 1))
+                for (const Square wk : SQUARES)
+                    for (const Square bk : SQUARES) {
+                        if (wk == pawn || bk == pawn || wk == bk) continue;
+                        board.PlacePiece(WHITE, PAWN, pawn);
+                        board.PlacePiece(WHITE, KING, wk);
+                        board.PlacePiece(BLACK, KING, bk);
+                        const Tablebase::WDL wdl = Tablebase::Probe(board);
+                        if (wdl != Tablebase::WDL::None) {
+                            probed++;
+                            const bool win = Endgame::Internal::KPKWin(WHITE, wk, pawn, bk, turn);
+                            CHECK_EQ(wdl != Tablebase::WDL::Draw, win);
+                            CHECK_NE(wdl, (turn == WHITE) ? Tablebase::WDL::Loss
+                                                          : Tablebase::WDL::Win);
+                        }
+                        board.RemovePiece(WHITE, PAWN, pawn);
+                        board.RemovePiece(WHITE, KING, wk);
+                        board.RemovePiece(BLACK, KING, bk);
+                    }
+        }
+        CHECK_GT(probed, 300000);
+    }
+
+    TEST_CASE("PROBE") {
+        Require();
+        const std::pair<std::string, Tablebase::WDL> positions[] = {
+            {"8/8/8/4k3/8/8/8/R3K3 w - - 0 1", Tablebase::WDL::Win},
+            {"8/8/8/4k3/8/8/8/R3K3 b - - 0 1", Tablebase::WDL::Loss},
+            // Black has the rook, for which the table is probed with the colors swapped
+            {"r3k3/8/8/8/3K4/8/8/8 b - - 0 1", Tablebase::WDL::Win},
+            {"r3k3/8/8/8/3K4/8/8/8 w - - 0 1", Tablebase::WDL::Loss},
+            // The rook is captured
+            {"8/8/8/8/8/8/1k6/R5K1 b - - 0 1", Tablebase::WDL::Draw},
+            {"8/8/8/8/8/8/1k6/R5K1 w - - 0 1", Tablebase::WDL::Win},
+            // Stalemate
+            {"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", Tablebase::WDL::Draw},
+            {"8/8/4k3/8/8/3BK3/8/8 w - - 0 1", Tablebase::WDL::Draw},
+            {"8/8/4k3/8/8/4K3/8/8 w - - 0 1", Tablebase::WDL::Draw},
+            // Not in any table
+            {"8/8/4k3/8/8/3BK3/8/7b w - - 0 1", Tablebase::WDL::None},
+            {"4k3/8/8/8/8/8/8/R3K3 w Q - 0 1", Tablebase::WDL::None},
+        };
+        for (const auto &[fen, wdl] : positions)
+            CHECK_EQ(Tablebase::Probe(Board(fen)), wdl);
+    }
+
+    TEST_CASE("EN PASSANT") {
+        Require();
+        // The endings after promotions stand in as drawn, as only the consistency of the table
+        // with those it leads to is checked
+        // Tables are "SBTB" and the number of positions, followed by two bits for each
+        const std::string promotions[] = {"KQvKP", "KRvKP", "KBvKP", "KNvKP"};
+        const uint32_t header[2]       = {0x42544253, 2 * 32 * 64 * 64 * 64};
+        for (const std::string &name : promotions) {
+            const std::string path = std::filesystem::path(DIRECTORY) / (name + ".wdl");
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<const char *>(header), sizeof(header));
+            file.write(std::vector<char>(header[1] / 4).data(), header[1] / 4);
+        }
+        Tablebase::Init(DIRECTORY);
+        REQUIRE(Tablebase::Internal::GenerateTable("KPvKP", DIRECTORY, 0));
+        Tablebase::Init(DIRECTORY);
+        REQUIRE_EQ(Tablebase::MaxPieces(), 4);
+
+        // Each position from which a pawn may step two squares past an opposing pawn is valued
+        // as the best of its moves, where the double push gives a choice of capturing en passant
+        size_t checked = 0, mismatched = 0, changed = 0;
+        for (const Color us : {WHITE, BLACK})
+            for (int column = 0; column < 8; column++)
+                for (const int side : {column - 1, column + 1}) {
+                    if (side < 0 || side > 7) continue;
+                    const Square pawn    = static_cast<Square>(((us == WHITE) ? 8 : 48) + column);
+                    const Square opposed = static_cast<Square>(((us == WHITE) ? 24 : 32) + side);
+                    const Square wp      = (us == WHITE) ? pawn : opposed;
+                    const Square bp      = (us == WHITE) ? opposed : pawn;
+                    for (const Square wk : SQUARES)
+                        for (const Square bk : SQUARES) {
+                            if (wk == bk || wk == wp || wk == bp || bk == wp || bk == bp) continue;
+                            Board board              = Place(us, wk, wp, bk, bp);
+                            const Tablebase::WDL wdl = Tablebase::Probe(board);
+                            if (wdl == Tablebase::WDL::None) continue;
+                            checked++;
+                            mismatched += static_cast<int>(wdl) != BestMove(board, changed);
+                        }
+                }
+        CHECK_GT(checked, 90000);
+        CHECK_GT(changed, 0);
+        CHECK_EQ(mismatched, 0);
+
+        for (const std::string &name : promotions)
+            std::filesystem::remove(std::filesystem::path(DIRECTORY) / (name + ".wdl"));
+        std::filesystem::remove(std::filesystem::path(DIRECTORY) / "KPvKP.wdl");
+        Tablebase::Init(DIRECTORY);
+        CHECK_EQ(Tablebase::MaxPieces(), 3);
+    }
+
+    TEST_CASE("SEARCH") {
+        Require();
+        // The rook is attacked, such that only some of its moves keep the win
+        Board board = Board("8/8/8/8/8/8/1k6/R5K1 w - - 0 1");
+        Search::Limits limits;
+        limits.depth = 4;
+        Search::SearchLimit limit;
+        TT::Init(1);
+        const PV pv = Search::GetBestMove(board, limits, limit);
+        TT::Clean();
+        REQUIRE_FALSE(pv.empty());
+        board.ApplyMove(pv[0]);
+        CHECK_EQ(Tablebase::Probe(board), Tablebase::WDL::Loss);
+        Tablebase::Init("");
+        CHECK_EQ(Tablebase::MaxPieces(), 0);
+        std::filesystem::remove_all(DIRECTORY);
+    }
+}
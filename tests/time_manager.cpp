@@ -0,0 +1,61 @@
+#include "move.hpp"
+#include "third_party/doctest.h"
+#include "time_manager.hpp"
+
+TEST_SUITE("TIME MANAGER") {
+    TEST_CASE("ALLOCATION") {
+        // Without moves to go, the time is spread over forty moves, keeping the move overhead
+        Search::Limits limits;
+        limits.time[WHITE] = 60000;
+        limits.time[BLACK] = 1000;
+        Search::TimeManager white(limits, WHITE);
+        CHECK_EQ(white.Optimum(), (60000 - 30) / 40);
+        CHECK_EQ(white.Maximum(), 5 * ((60000 - 30) / 40));
+
+        // Each of the remaining moves receives the increment as well
+        limits.inc[WHITE] = 1000;
+        CHECK_EQ(Search::TimeManager(limits, WHITE).Optimum(), (60000 + 39 * 1000 - 30) / 40);
+
+        // The last move before the time control may use most, though not all, of the time
+        limits.movesToGo = 1;
+        const Search::TimeManager last(limits, BLACK);
+        CHECK_EQ(last.Optimum(), (1000 - 30) * 9 / 10);
+        CHECK_EQ(last.Maximum(), last.Optimum());
+
+        // Fixed times and infinite searches are not managed
+        limits.moveTime = 500;
+        CHECK_EQ(Search::TimeManager(limits, WHITE).Maximum(), 500 - 30);
+        CHECK_FALSE(Search::TimeManager(limits, WHITE).ShouldStop(10000));
+        limits.moveTime.reset();
+        limits.infinite = true;
+        CHECK_EQ(Search::TimeManager(limits, WHITE).Maximum(), Search::TimeManager::UNLIMITED);
+    }
+
+    TEST_CASE("STABILITY") {
+        Search::Limits limits;
+        limits.time[WHITE]   = 60000;
+        const size_t optimum = (60000 - 30) / 40;
+        const Move a         = Move(E2, E4, Move::DoublePawnPush);
+        const Move b         = Move(D2, D4, Move::DoublePawnPush);
+
+        // A stable best move stops the search at the optimum
+        Search::TimeManager stable(limits, WHITE);
+        stable.Update(100, a, 0, 0.5);
+        stable.Update(150, a, 0, 0.5);
+        CHECK_FALSE(stable.ShouldStop(optimum - 1));
+        CHECK(stable.ShouldStop(optimum));
+
+        // A changing best move extends the search beyond it
+        Search::TimeManager unstable(limits, WHITE);
+        unstable.Update(100, a, 0, 0.5);
+        unstable.Update(150, b, 0, 0.5);
+        CHECK_FALSE(unstable.ShouldStop(optimum));
+        CHECK(unstable.ShouldStop(2 * optimum));
+
+        // No iteration is started which is not expected to finish before the maximum
+        Search::TimeManager slow(limits, WHITE);
+        slow.Update(100, a, 0, 0.5);
+        slow.Update(2000, b, 0, 0.5);
+        CHECK(slow.ShouldStop(optimum));
+    }
+}